@@ -0,0 +1,325 @@
+/**
+ * @file AutoTuner.cpp
+ * @brief Implementation of AutoTuner's sampled bisection and full-data confirmation.
+ */
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#include "AutoTuner.hpp"
+#include "../utils/column.hpp"
+#include "../utils/utils.hpp"
+
+namespace {
+
+/**
+ * @brief True if text is an integer literal (optional sign, digits only).
+ */
+bool isIntegerLiteral(const std::string& text) {
+    size_t start = (!text.empty() && (text[0] == '-' || text[0] == '+')) ? 1 : 0;
+    return start < text.size() && std::all_of(text.begin() + start, text.end(), [](char c) {
+        return c >= '0' && c <= '9';
+    });
+}
+
+/**
+ * @brief True if a is at least as good as b in ratio, throughput and error, and better in one.
+ */
+bool dominates(const BenchmarkResult& a, const BenchmarkResult& b) {
+    bool noWorse = a.compressionRatio >= b.compressionRatio &&
+                   a.compressionThroughputMBps >= b.compressionThroughputMBps &&
+                   a.maxAbsError <= b.maxAbsError;
+    bool better = a.compressionRatio > b.compressionRatio ||
+                  a.compressionThroughputMBps > b.compressionThroughputMBps ||
+                  a.maxAbsError < b.maxAbsError;
+    return noWorse && better;
+}
+
+} // namespace
+
+TuneRange parseTuneRange(const std::string& spec) {
+    size_t equals = spec.find('=');
+    size_t dots = spec.find("..", equals == std::string::npos ? 0 : equals);
+    if (equals == std::string::npos || equals == 0 || dots == std::string::npos) {
+        throw std::invalid_argument("Tuning ranges must look like option=min..max: " + spec);
+    }
+
+    std::string minText = spec.substr(equals + 1, dots - equals - 1);
+    std::string maxText = spec.substr(dots + 2);
+
+    TuneRange range;
+    range.option = spec.substr(0, equals);
+    range.min = std::stod(minText);
+    range.max = std::stod(maxText);
+    range.integer = isIntegerLiteral(minText) && isIntegerLiteral(maxText);
+    if (range.min >= range.max) {
+        throw std::invalid_argument("Tuning ranges must have min < max: " + spec);
+    }
+    return range;
+}
+
+void markParetoFront(std::vector<TuneCandidate>& candidates) {
+    for (TuneCandidate& candidate : candidates) {
+        candidate.pareto = candidate.feasible && std::none_of(candidates.begin(), candidates.end(),
+            [&candidate](const TuneCandidate& other) {
+                return other.feasible && dominates(other.result, candidate.result);
+            });
+    }
+}
+
+template <typename T>
+AutoTuner<T>::AutoTuner(int chunkSize, const std::string& compressorName, const TuneRange& range, double maxAbsError)
+    : chunkSize_(chunkSize), compressorName_(compressorName), range_(range), maxAbsError_(maxAbsError)
+{
+    if (range.min >= range.max) {
+        throw std::invalid_argument("Tuning range must have min < max");
+    }
+}
+
+template <typename T>
+void AutoTuner<T>::setSampleFraction(double sampleFraction) {
+    if (!(sampleFraction > 0.0 && sampleFraction <= 1.0)) {
+        throw std::invalid_argument("Sample fraction must be in (0,1]");
+    }
+    sampleFraction_ = sampleFraction;
+}
+
+template <typename T>
+double AutoTuner<T>::getSampleFraction() const {
+    return sampleFraction_;
+}
+
+template <typename T>
+void AutoTuner<T>::setMaxIterations(int maxIterations) {
+    if (maxIterations < 1) {
+        throw std::invalid_argument("Tuning needs at least one iteration");
+    }
+    maxIterations_ = maxIterations;
+}
+
+template <typename T>
+int AutoTuner<T>::getMaxIterations() const {
+    return maxIterations_;
+}
+
+template <typename T>
+void AutoTuner<T>::setNumThreads(int numThreads) {
+    if (numThreads < 1) {
+        throw std::invalid_argument("Number of threads must be at least 1");
+    }
+    numThreads_ = numThreads;
+}
+
+template <typename T>
+int AutoTuner<T>::getNumThreads() const {
+    return numThreads_;
+}
+
+template <typename T>
+void AutoTuner<T>::setErrorThreads(int errorThreads) {
+    if (errorThreads < 1) {
+        throw std::invalid_argument("Number of error threads must be at least 1");
+    }
+    errorThreads_ = errorThreads;
+}
+
+template <typename T>
+int AutoTuner<T>::getErrorThreads() const {
+    return errorThreads_;
+}
+
+template <typename T>
+void AutoTuner<T>::setWarmupRuns(int warmupRuns) {
+    if (warmupRuns < 0) {
+        throw std::invalid_argument("warmupRuns must not be negative");
+    }
+    warmupRuns_ = warmupRuns;
+}
+
+template <typename T>
+int AutoTuner<T>::getWarmupRuns() const {
+    return warmupRuns_;
+}
+
+template <typename T>
+void AutoTuner<T>::setTrials(int trials) {
+    if (trials < 1) {
+        throw std::invalid_argument("trials must be at least 1");
+    }
+    trials_ = trials;
+}
+
+template <typename T>
+int AutoTuner<T>::getTrials() const {
+    return trials_;
+}
+
+template <typename T>
+void AutoTuner<T>::setTimingClock(TimingClock clock) {
+    clock_ = clock;
+}
+
+template <typename T>
+TimingClock AutoTuner<T>::getTimingClock() const {
+    return clock_;
+}
+
+template <typename T>
+void AutoTuner<T>::setPerfCounters(bool enabled) {
+    perfCounters_ = enabled;
+}
+
+template <typename T>
+bool AutoTuner<T>::getPerfCounters() const {
+    return perfCounters_;
+}
+
+template <typename T>
+void AutoTuner<T>::setChunkBoundaries(std::vector<size_t> boundaries) {
+    chunkBoundaries_ = std::move(boundaries);
+}
+
+template <typename T>
+void AutoTuner<T>::setData(std::span<const T> data) {
+    data_ = data;
+
+    std::vector<size_t> boundaries = chunkBoundaries_.empty()
+        ? fixedChunkBoundaries(data.size(), std::max<size_t>(chunkSize_ / sizeof(T), 1))
+        : chunkBoundaries_;
+    size_t numChunks = boundaries.size() - 1;
+    size_t numSampled = std::clamp<size_t>(std::llround(numChunks * sampleFraction_), 1, std::max<size_t>(numChunks, 1));
+
+    sample_.clear();
+    sampleBoundaries_.assign(1, 0);
+    sampleIsFull_ = (numSampled >= numChunks);
+    if (sampleIsFull_) {
+        return;
+    }
+
+    // Evenly spaced chunks, copied whole so each keeps its own boundaries
+    for (size_t i = 0; i < numSampled; ++i) {
+        size_t chunk = i * numChunks / numSampled;
+        sample_.insert(sample_.end(), data.begin() + boundaries[chunk], data.begin() + boundaries[chunk + 1]);
+        sampleBoundaries_.push_back(sample_.size());
+    }
+
+    std::cout << timeMessage(std::format("Tuning {} on {} of {} chunks ({} values)",
+                                         range_.option, numSampled, numChunks, sample_.size())) << std::endl;
+}
+
+template <typename T>
+TuneCandidate AutoTuner<T>::tune(const std::map<std::string, std::string>& options) const {
+    if (!options.contains(range_.option)) {
+        throw std::invalid_argument("Cannot tune '" + range_.option + "': not an option of the compressor");
+    }
+
+    TuneCandidate candidate;
+    auto evaluateSample = [&](double value) {
+        ++candidate.sampleEvaluations;
+        return evaluate(options, value, false);
+    };
+
+    // Next value to try between a setting that meets the bound and one that does not
+    auto midpoint = [this](double a, double b) {
+        if (range_.integer) {
+            return std::floor((a + b) / 2.0);
+        }
+        return (a > 0.0 && b > 0.0) ? std::sqrt(a * b) : (a + b) / 2.0;
+    };
+
+    // The end of the range with the larger error is the loose one
+    BenchmarkResult minResult = evaluateSample(range_.min);
+    BenchmarkResult maxResult = evaluateSample(range_.max);
+    bool looseIsMax = maxResult.maxAbsError >= minResult.maxAbsError;
+    double loose = looseIsMax ? range_.max : range_.min;
+    double tight = looseIsMax ? range_.min : range_.max;
+    const BenchmarkResult& looseResult = looseIsMax ? maxResult : minResult;
+    const BenchmarkResult& tightResult = looseIsMax ? minResult : maxResult;
+
+    double good = tight;
+    candidate.sampleResult = tightResult;
+    if (looseResult.maxAbsError <= maxAbsError_) {
+        good = loose;
+        candidate.sampleResult = looseResult;
+    } else if (tightResult.maxAbsError <= maxAbsError_) {
+        // Bisect between the tightest setting that meets the bound and the loosest that does not
+        double bad = loose;
+        for (int iteration = 0; range_.integer ? std::abs(bad - good) > 1.0 : iteration < maxIterations_; ++iteration) {
+            double mid = midpoint(good, bad);
+            BenchmarkResult midResult = evaluateSample(mid);
+            if (midResult.maxAbsError <= maxAbsError_) {
+                good = mid;
+                candidate.sampleResult = midResult;
+            } else {
+                bad = mid;
+            }
+        }
+    }
+
+    // Confirm on the full data; tighten the winner while the unsampled chunks break the bound
+    // (when every chunk was sampled, the search already ran on the full data)
+    bool reuseSample = sampleIsFull_;
+    for (;;) {
+        if (reuseSample) {
+            candidate.result = candidate.sampleResult;
+            reuseSample = false;
+        } else {
+            ++candidate.fullEvaluations;
+            candidate.result = evaluate(options, good, true);
+        }
+        if (candidate.result.maxAbsError <= maxAbsError_ || good == tight) {
+            break;
+        }
+        if (range_.integer) {
+            good += (tight > good) ? 1.0 : -1.0;
+        } else {
+            good = (candidate.fullEvaluations >= maxIterations_) ? tight : midpoint(good, tight);
+        }
+    }
+
+    candidate.feasible = candidate.result.maxAbsError <= maxAbsError_;
+    candidate.value = formatValue(good);
+    candidate.options = options;
+    candidate.options[range_.option] = candidate.value;
+
+    std::cout << timeMessage(std::format("Tuned {}={} ({}): ratio {:.3f}, maxAbsError {:.6g}, {} sample + {} full runs",
+                                         range_.option, candidate.value, candidate.feasible ? "meets bound" : "exceeds bound",
+                                         candidate.result.compressionRatio, candidate.result.maxAbsError,
+                                         candidate.sampleEvaluations, candidate.fullEvaluations)) << std::endl;
+    return candidate;
+}
+
+template <typename T>
+BenchmarkResult AutoTuner<T>::evaluate(std::map<std::string, std::string> options, double value, bool full) const {
+    options[range_.option] = formatValue(value);
+
+    CompressorBenchmark<T> benchmark(chunkSize_, compressorName_, options);
+    benchmark.setNumThreads(numThreads_);
+    benchmark.setErrorThreads(errorThreads_);
+    if (full || sampleIsFull_) {
+        // These results are the ones reported, so they get the requested timing
+        benchmark.setWarmupRuns(warmupRuns_);
+        benchmark.setTrials(trials_);
+        benchmark.setTimingClock(clock_);
+        benchmark.setPerfCounters(perfCounters_);
+        benchmark.setChunkBoundaries(chunkBoundaries_);
+        return benchmark.run(data_);
+    }
+    benchmark.setChunkBoundaries(sampleBoundaries_);
+    return benchmark.run(sample_);
+}
+
+template <typename T>
+std::string AutoTuner<T>::formatValue(double value) const {
+    if (range_.integer) {
+        return std::to_string(std::llround(value));
+    }
+    return std::format("{:.9g}", value);
+}
+
+template class AutoTuner<float>;
+template class AutoTuner<double>;
+template class AutoTuner<int32_t>;
+template class AutoTuner<char>;
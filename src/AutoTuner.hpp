@@ -0,0 +1,176 @@
+/**
+ * @file AutoTuner.hpp
+ * @brief Search for the loosest compressor setting that stays within an error bound.
+ */
+#pragma once
+
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "CompressorBenchmark.hpp"
+
+/**
+ * @brief Range searched for one numeric compressor option.
+ */
+struct TuneRange {
+    std::string option{};   // Compressor option to tune, e.g. "mantissaBits" or "errorBoundValue"
+    double min{};
+    double max{};
+    bool integer{true};     // Search integers only (otherwise the range is bisected in log space)
+};
+
+/**
+ * @brief Outcome of tuning one compressor configuration.
+ */
+struct TuneCandidate {
+    std::map<std::string, std::string> options{};  // Options of the winner (or of the tightest setting if none fit)
+    std::string value{};                            // Tuned option's value in options
+    bool feasible{false};                           // Some setting met the bound on the full data
+    bool pareto{false};                             // On the ratio/throughput/error Pareto front
+    int sampleEvaluations{};                        // Benchmarks run on the sampled chunks
+    int fullEvaluations{};                          // Benchmarks run on the full data
+    BenchmarkResult sampleResult{};                 // Winner on the sampled chunks
+    BenchmarkResult result{};                       // Winner on the full data
+};
+
+/**
+ * @brief Parse a tuning range of the form option=min..max.
+ *
+ * The range is integer if both ends are written as integers, e.g. "mantissaBits=0..23",
+ * and continuous otherwise, e.g. "errorBoundValue=1e-6..1e-1".
+ *
+ * @throws std::invalid_argument if the range is malformed.
+ */
+TuneRange parseTuneRange(const std::string& spec);
+
+/**
+ * @brief Flag the candidates on the Pareto front of compression ratio, compression
+ *        throughput and maxAbsError, among the feasible ones.
+ *
+ * A candidate is on the front if no other feasible candidate is at least as good in all
+ * three and strictly better in one. Results on the full data are compared.
+ */
+void markParetoFront(std::vector<TuneCandidate>& candidates);
+
+/**
+ * @class AutoTuner
+ * @brief Find the setting of one option that compresses most while keeping maxAbsError
+ *        within a bound.
+ *
+ * maxAbsError is assumed monotonic in the tuned option (it is for TruncCompressor's
+ * mantissaBits and SZ3's errorBoundValue). Candidates are evaluated on an evenly spaced
+ * sample of the chunks: the ends of the range fix the search direction, and the range is
+ * then bisected. The winner is confirmed on the full data and, should it exceed the bound
+ * there, tightened until it does not.
+ */
+template <typename T>
+class AutoTuner {
+public:
+    /**
+     * @brief Construct an AutoTuner.
+     * @param chunkSize Size of chunks that get compressed, in bytes.
+     * @param compressorName Name of the compressor to tune.
+     * @param range Option to tune and the range to search.
+     * @param maxAbsError Largest acceptable maximum absolute error.
+     */
+    AutoTuner(int chunkSize, const std::string& compressorName, const TuneRange& range, double maxAbsError);
+
+    /**
+     * @brief Set the fraction of chunks evaluated during the search (default 0.1).
+     *
+     * At least one chunk is always sampled; 1 searches on the full data.
+     */
+    void setSampleFraction(double sampleFraction);
+    double getSampleFraction() const;
+
+    /**
+     * @brief Set the number of bisection steps for continuous ranges (default 20).
+     */
+    void setMaxIterations(int maxIterations);
+    int getMaxIterations() const;
+
+    /**
+     * @brief Set the number of worker threads of each benchmark (see CompressorBenchmark::setNumThreads()).
+     */
+    void setNumThreads(int numThreads);
+    int getNumThreads() const;
+
+    /**
+     * @brief Set the number of threads accumulating each benchmark's error metrics after
+     *        its trials (see CompressorBenchmark::setErrorThreads()).
+     */
+    void setErrorThreads(int errorThreads);
+    int getErrorThreads() const;
+
+    /**
+     * @brief Set the timing of the benchmarks whose results are reported (see
+     *        CompressorBenchmark::setWarmupRuns(), setTrials(), setTimingClock() and
+     *        setPerfCounters()).
+     *
+     * They apply to the full-data confirmation runs, and to the search when it runs on the
+     * full data. Search runs on the sample only compare maxAbsError and are timed once.
+     */
+    void setWarmupRuns(int warmupRuns);
+    int getWarmupRuns() const;
+    void setTrials(int trials);
+    int getTrials() const;
+    void setTimingClock(TimingClock clock);
+    TimingClock getTimingClock() const;
+    void setPerfCounters(bool enabled);
+    bool getPerfCounters() const;
+
+    /**
+     * @brief Use explicit chunk boundaries (see CompressorBenchmark::setChunkBoundaries()).
+     */
+    void setChunkBoundaries(std::vector<size_t> boundaries);
+
+    /**
+     * @brief Set the data to tune on and draw the sampled chunks from it.
+     *
+     * Call after the setters above. The data is not copied and must outlive the tuner.
+     */
+    void setData(std::span<const T> data);
+
+    /**
+     * @brief Tune one configuration on the data given to setData().
+     *
+     * Does not modify the tuner, so several configurations can be tuned concurrently.
+     *
+     * @param options Compressor options; the tuned option's value is replaced.
+     * @return The winner and its results on the sample and on the full data.
+     */
+    TuneCandidate tune(const std::map<std::string, std::string>& options) const;
+
+private:
+    int chunkSize_;                             ///< Size of chunks that get compressed
+    std::string compressorName_;                ///< Compressor to tune
+    TuneRange range_;                           ///< Option to tune and its range
+    double maxAbsError_;                        ///< Bound on maxAbsError
+    double sampleFraction_{0.1};                ///< Fraction of chunks in the sample
+    int maxIterations_{20};                     ///< Bisection steps for continuous ranges
+    int numThreads_{1};                         ///< Worker threads per benchmark
+    int errorThreads_{1};                       ///< Threads accumulating error metrics per benchmark
+    int warmupRuns_{0};                         ///< Untimed runs before the trials of reported benchmarks
+    int trials_{1};                             ///< Timed runs of reported benchmarks
+    TimingClock clock_{TimingClock::Wall};      ///< Clock reported benchmarks are timed with
+    bool perfCounters_{false};                  ///< Count hardware events in reported benchmarks
+    std::vector<size_t> chunkBoundaries_;       ///< Explicit chunk boundaries (empty = fixed chunkSize chunks)
+
+    std::span<const T> data_;                   ///< Full data
+    std::vector<T> sample_;                     ///< Values of the sampled chunks
+    std::vector<size_t> sampleBoundaries_;      ///< Chunk boundaries within sample_
+    bool sampleIsFull_{false};                  ///< Every chunk was sampled, so sample_ is unused
+
+    /**
+     * @brief Benchmark the options with the tuned option set to value.
+     * @param full Run on the full data rather than on the sample.
+     */
+    BenchmarkResult evaluate(std::map<std::string, std::string> options, double value, bool full) const;
+
+    /**
+     * @brief Format a value of the tuned option as a compressor option string.
+     */
+    std::string formatValue(double value) const;
+};
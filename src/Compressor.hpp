@@ -1,4 +1,3 @@
-
 /**
  * @file Compressor.hpp
  * @brief Abstract base class for data compressors.
@@ -6,6 +5,7 @@
 #pragma once
 
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -13,13 +13,20 @@
 #include <cstdint>
 
 struct CompressedData {
-    std::vector<uint8_t> data;      // Compressed data
-    size_t numFloats;               // Number of floats in original uncompressed data
-    std::map<std::string, std::string> compressorConfig;        // Compressor-specific configuration parameters
+    std::vector<uint8_t> data;      // Compressed data buffer; reused across calls, only the first numBytes are valid
+    size_t numBytes{};              // Number of valid compressed bytes in data
+    size_t numElements{};           // Number of elements in original uncompressed data
 };
 
+/**
+ * @class Compressor
+ * @brief Compressor for columns with element type T (float, double, int32_t or char).
+ */
+template <typename T>
 class Compressor {
 public:
+    using value_type = T;
+
     /**
      * @brief Virtual destructor.
      */
@@ -29,16 +36,27 @@ public:
     virtual std::map<std::string, std::string> getConfig() const = 0;
 
     /**
-     * @brief Compress the input data.
-     * @param data Vector of floats representing the uncompressed data.
-     * @return CompressedData structure containing compressed byte data and metadata.
+     * @brief Upper bound on the compressed size of a chunk, used to preallocate output buffers.
+     * @param numElements Number of elements in the uncompressed chunk.
+     * @return Maximum number of bytes compress() can produce for that chunk.
      */
-    virtual CompressedData compress(const std::vector<float>& data) = 0;
+    virtual size_t compressBound(size_t numElements) const = 0;
 
     /**
-     * @brief Decompress the input compressed data.
+     * @brief Compress the input data into a caller-provided buffer.
+     *
+     * The buffer in compressed.data is only grown when it is too small, so reusing
+     * the same CompressedData across calls avoids per-call allocation.
+     *
+     * @param data View of the uncompressed data.
+     * @param compressed CompressedData structure receiving compressed byte data and metadata.
+     */
+    virtual void compress(std::span<const T> data, CompressedData& compressed) = 0;
+
+    /**
+     * @brief Decompress the input compressed data into a caller-provided buffer.
      * @param compressed CompressedData structure containing compressed byte data and metadata.
-     * @return Vector of floats representing the decompressed data.
+     * @param output View of compressed.numElements elements receiving the decompressed data.
      */
-    virtual std::vector<float> decompress(const CompressedData& compressed) = 0;
-};
\ No newline at end of file
+    virtual void decompress(const CompressedData& compressed, std::span<T> output) = 0;
+};
@@ -3,149 +3,857 @@
  * @file CompressorBenchmark.cpp
  * @brief Implementation of CompressorBenchmark for benchmarking data compressors and recording results.
  */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
 #include <iostream>
 #include <format>
 #include <cmath>
-#include <numeric>
+#include <limits>
 #include <optional>
+#include <thread>
 
 #include "CompressorBenchmark.hpp"
+#include "ErrorAccumulator.hpp"
+#include "../utils/column.hpp"
+#include "../utils/queue.hpp"
 #include "../utils/utils.hpp"
 
-BenchmarkResult CompressorBenchmark::run(const std::vector<float>& data, bool returnDecompressed) {
+namespace {
+
+/**
+ * @brief Convert a byte count processed in a given time to MB/s.
+ */
+double throughputMBps(size_t numBytes, double timeMs) {
+    return numBytes / (timeMs * 1e-3) / (1024 * 1024);
+}
+
+/**
+ * @brief Convert a time in milliseconds to whole nanoseconds.
+ */
+uint64_t toNs(double timeMs) {
+    return static_cast<uint64_t>(std::llround(std::max(timeMs, 0.0) * 1e6));
+}
+
+/**
+ * @brief Fill the error metrics of a result from accumulated chunk errors.
+ * @param numThreads Threads merging the sorted chunks of exact distributions.
+ */
+template <typename T>
+void fillErrorMetrics(const ErrorAccumulator<T>& errors, BenchmarkResult& result, int numThreads = 1) {
+    if (errors.count() == 0) {
+        return;
+    }
+    errors.mergeRuns(numThreads);
+
+    result.MSE = errors.MSE();
+    result.PSNR = errors.PSNR();
+    result.meanAbsError = errors.meanAbsError();
+    result.maxAbsError = errors.maxAbsError();
+    result.meanRelError = errors.meanRelError();
+    result.maxRelError = errors.maxRelError();
+    result.KLdivergence = errors.KLDivergence();
+    result.JSdivergence = errors.JSDivergence();
+    result.WassersteinDistance = errors.WassersteinDistance();
+    result.KSstatistic = errors.KSStatistic();
+    result.exactDistributions = errors.exactDistributions();
+}
+
+} // namespace
+
+template <typename T>
+std::shared_ptr<Compressor<T>> makeCompressor(const std::string& compressorName,
+                                              const std::map<std::string, std::string>& compressorOptions) {
+    if (compressorName == "BitTruncation") {
+        return std::make_shared<TruncCompressor<T>>(compressorOptions);
+    } else if (compressorName == "ROOT") {
+        return std::make_shared<RootCompressor<T>>(compressorOptions);
+    } else if (compressorName == "SZ3") {
+        if constexpr (std::is_same_v<T, char>) {
+            throw std::invalid_argument("SZ3 does not support char columns");
+        } else {
+            return std::make_shared<SZ3Compressor<T>>(compressorOptions);
+        }
+    } else {
+        throw std::invalid_argument("Unknown compressor: " + compressorName);
+    }
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setNumThreads(int numThreads) {
+    if (numThreads < 1) {
+        throw std::invalid_argument("numThreads must be at least 1");
+    }
+    numThreads_ = numThreads;
+}
+
+template <typename T>
+int CompressorBenchmark<T>::getNumThreads() const {
+    return numThreads_;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setWarmupRuns(int warmupRuns) {
+    if (warmupRuns < 0) {
+        throw std::invalid_argument("warmupRuns must not be negative");
+    }
+    warmupRuns_ = warmupRuns;
+}
+
+template <typename T>
+int CompressorBenchmark<T>::getWarmupRuns() const {
+    return warmupRuns_;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setTrials(int trials) {
+    if (trials < 1) {
+        throw std::invalid_argument("trials must be at least 1");
+    }
+    trials_ = trials;
+}
+
+template <typename T>
+int CompressorBenchmark<T>::getTrials() const {
+    return trials_;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setTimingClock(TimingClock clock) {
+    clock_ = clock;
+}
+
+template <typename T>
+TimingClock CompressorBenchmark<T>::getTimingClock() const {
+    return clock_;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setPerfCounters(bool enabled) {
+    perfCounters_ = enabled;
+}
+
+template <typename T>
+bool CompressorBenchmark<T>::getPerfCounters() const {
+    return perfCounters_;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setChunkRecords(bool enabled) {
+    chunkRecords_ = enabled;
+}
+
+template <typename T>
+bool CompressorBenchmark<T>::getChunkRecords() const {
+    return chunkRecords_;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setErrorThreads(int errorThreads) {
+    if (errorThreads < 1) {
+        throw std::invalid_argument("errorThreads must be at least 1");
+    }
+    errorThreads_ = errorThreads;
+}
+
+template <typename T>
+int CompressorBenchmark<T>::getErrorThreads() const {
+    return errorThreads_;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setExactDistributions(bool enabled) {
+    exactDistributions_ = enabled;
+}
+
+template <typename T>
+bool CompressorBenchmark<T>::getExactDistributions() const {
+    return exactDistributions_;
+}
+
+template <typename T>
+BenchmarkResult CompressorBenchmark<T>::run(std::span<const T> data, std::span<T> decompressed) {
     if (!compressor_) {
         throw std::runtime_error("Compressor not initialized");
     }
 
     std::cout << timeMessage(std::format(
-        "Running benchmark for compressor '{}' with chunkSize {} bytes", 
-        compressor_->toString(), chunkSize_)
+        "Running benchmark for compressor '{}' with chunkSize {} bytes on {} thread(s), {} warmup run(s) and {} trial(s) on the {} clock",
+        compressor_->toString(), chunkSize_, numThreads_, warmupRuns_, trials_, timingClockName(clock_))
     ) << std::endl;
     
+    BenchmarkResult result;
+    result.numThreads = numThreads_;
+
+    // Output buffers are allocated once and reused by every chunk
+    if (!decompressed.empty() && decompressed.size() != data.size()) {
+        throw std::invalid_argument("Decompressed buffer must have as many elements as the input data");
+    }
+    std::vector<T> scratch;
+    if (decompressed.empty()) {
+        scratch.resize(data.size());
+    }
+    std::span<T> decompressedData = decompressed.empty() ? std::span<T>(scratch) : decompressed;
+    size_t totalBytes = data.size() * sizeof(T);
+    size_t totalCompressedBytes = 0;
+
+    // Chunk boundaries, as value offsets into data
+    std::vector<size_t> boundaries = chunkBoundaries(data.size());
+    size_t numChunks = boundaries.size() - 1;
+    result.numChunks = numChunks;
+
+    // Chunk records are filled in place by the last trial
+    if (chunkRecords_) {
+        result.chunkRecords.resize(numChunks);
+        for (size_t chunkInx = 0; chunkInx < numChunks; ++chunkInx) {
+            result.chunkRecords[chunkInx].chunkIndex = chunkInx;
+            result.chunkRecords[chunkInx].inputBytes = (boundaries[chunkInx + 1] - boundaries[chunkInx]) * sizeof(T);
+        }
+    }
+
+    // Errors are accumulated chunk by chunk, right after each chunk is decompressed
+    ErrorAccumulator<T> errors(exactDistributions_);
+
+    // Throughput of every trial; warmup runs are not recorded
+    std::vector<double> compressionTrials;
+    std::vector<double> decompressionTrials;
+
+    if (numThreads_ > 1) {
+        totalCompressedBytes = runParallelChunks(data, boundaries, decompressedData, result,
+                                                 compressionTrials, decompressionTrials, errors);
+    } else {
+        totalCompressedBytes = runSerialChunks(data, boundaries, decompressedData,
+                                               compressionTrials, decompressionTrials, errors, result);
+        if (errorThreads_ > 1) {
+            accumulateErrorsParallel(data, boundaries, decompressedData, errors, result);
+        }
+    }
+
+    // Report the median trial, with the spread over all trials
+    result.clock = timingClockName(clock_);
+    result.warmupRuns = warmupRuns_;
+    result.compressionStats = summarizeThroughputs(compressionTrials);
+    result.decompressionStats = summarizeThroughputs(decompressionTrials);
+    result.compressionThroughputMBps = result.compressionStats.median;
+    result.decompressionThroughputMBps = result.decompressionStats.median;
+    if (numThreads_ == 1) {
+        result.threadCompressionThroughputMBps = {result.compressionThroughputMBps};
+        result.threadDecompressionThroughputMBps = {result.decompressionThroughputMBps};
+    }
+    if (trials_ > 1) {
+        std::cout << timeMessage(std::format(
+            "Compression {:.1f} MB/s (p5 {:.1f}, p95 {:.1f}), decompression {:.1f} MB/s (p5 {:.1f}, p95 {:.1f}) over {} trials",
+            result.compressionStats.median, result.compressionStats.p5, result.compressionStats.p95,
+            result.decompressionStats.median, result.decompressionStats.p5, result.decompressionStats.p95, trials_)
+        ) << std::endl;
+    }
+
+    if (result.compressionPerf.any()) {
+        std::cout << timeMessage(std::format(
+            "Compression {:.2f} cycles/byte at IPC {:.2f}, decompression {:.2f} cycles/byte at IPC {:.2f}",
+            result.compressionPerf.cyclesPerByte(), result.compressionPerf.IPC(),
+            result.decompressionPerf.cyclesPerByte(), result.decompressionPerf.IPC())
+        ) << std::endl;
+    }
+
+    // Calculate overall compression ratio
+    result.compressionRatio = totalBytes / static_cast<double>(totalCompressedBytes);
+
+    fillErrorMetrics(errors, result, std::max(numThreads_, errorThreads_));
+
+    return result;
+}
+
+template <typename T>
+BenchmarkResult CompressorBenchmark<T>::runStream(const std::function<bool(std::vector<T>&)>& nextChunk) {
+    if (!compressor_) {
+        throw std::runtime_error("Compressor not initialized");
+    }
+
+    std::cout << timeMessage(std::format(
+        "Running streaming benchmark for compressor '{}' with chunkSize {} bytes",
+        compressor_->toString(), chunkSize_)
+    ) << std::endl;
+
     // Set up accumulators
     double totalCompressionTimeMs = 0.0;
     double totalDecompressionTimeMs = 0.0;
+    size_t totalBytes = 0;
     size_t totalCompressedBytes = 0;
+    size_t numChunks = 0;
+    ErrorAccumulator<T> errors;
 
-    // Perform compression in chunks
-    // Chunk size is in bytes
-    std::vector<float> decompressedData;
-    size_t totalBytes = data.size() * sizeof(float);
-    int numChunks = std::ceil(static_cast<double>(totalBytes) / chunkSize_);
+    // Buffers are reused by every chunk
+    std::vector<T> chunk;
+    std::vector<T> decompressedChunk;
+    CompressedData compressedChunk;
 
-    for (int chunkInx = 0; chunkInx < numChunks; ++chunkInx) {
-        // Get next chunk
-        size_t offset = chunkInx * chunkSize_;
-        size_t end = std::min(offset + chunkSize_, totalBytes);
-        size_t numFloats = (end - offset) / sizeof(float);
-        std::vector<float> chunk(data.begin() + (offset / sizeof(float)), data.begin() + (offset / sizeof(float)) + numFloats);
+    while (nextChunk(chunk)) {
+        if (decompressedChunk.size() < chunk.size()) {
+            decompressedChunk.resize(chunk.size());
+            compressedChunk.data.resize(compressor_->compressBound(chunk.size()));
+        }
+        std::span<T> decompressed{decompressedChunk.data(), chunk.size()};
 
         // Compress chunk
-        auto startCompression = std::chrono::high_resolution_clock::now();
-        CompressedData compressedChunk = compressor_->compress(chunk);
-        auto endCompression = std::chrono::high_resolution_clock::now();
+        double startCompression = clockMs(clock_);
+        compressor_->compress(chunk, compressedChunk);
+        double endCompression = clockMs(clock_);
+        totalCompressionTimeMs += endCompression - startCompression;
 
-        // Record compression time and compressed size
-        double chunkCompressionTimeMs = std::chrono::duration<double, std::milli>(endCompression - startCompression).count();
-        totalCompressionTimeMs += chunkCompressionTimeMs;
+        // Decompress chunk
+        double startDecompression = clockMs(clock_);
+        compressor_->decompress(compressedChunk, decompressed);
+        double endDecompression = clockMs(clock_);
+        totalDecompressionTimeMs += endDecompression - startDecompression;
 
-        totalCompressedBytes += compressedChunk.data.size();
+        // Accumulate sizes and errors while the chunk is still in memory
+        numChunks += 1;
+        totalBytes += chunk.size() * sizeof(T);
+        totalCompressedBytes += compressedChunk.numBytes;
+        errors.update(chunk, decompressed);
+    }
 
-        // Decompress chunk
-        auto startDecompression = std::chrono::high_resolution_clock::now();
-        std::vector<float> decompressedChunk = compressor_->decompress(compressedChunk);
-        auto endDecompression = std::chrono::high_resolution_clock::now();
+    BenchmarkResult result;
+    result.numChunks = numChunks;
+    result.clock = timingClockName(clock_);
+    result.compressionThroughputMBps = throughputMBps(totalBytes, totalCompressionTimeMs);
+    result.decompressionThroughputMBps = throughputMBps(totalBytes, totalDecompressionTimeMs);
+    result.threadCompressionThroughputMBps = {result.compressionThroughputMBps};
+    result.threadDecompressionThroughputMBps = {result.decompressionThroughputMBps};
+    result.compressionRatio = totalBytes / static_cast<double>(totalCompressedBytes);
 
-        // Record decompression time and decompressed data
-        double chunkDecompressionTimeMs = std::chrono::duration<double, std::milli>(endDecompression - startDecompression).count();
-        totalDecompressionTimeMs += chunkDecompressionTimeMs;
+    fillErrorMetrics(errors, result);
 
-        std::move(decompressedChunk.begin(), decompressedChunk.end(), std::back_inserter(decompressedData));
+    return result;
+}
+
+template <typename T>
+BenchmarkResult CompressorBenchmark<T>::runPipeline(const std::function<bool(std::vector<T>&)>& nextChunk, size_t queueDepth) {
+    if (!compressor_) {
+        throw std::runtime_error("Compressor not initialized");
+    }
+    if (queueDepth == 0) {
+        throw std::invalid_argument("queueDepth must be at least 1");
     }
 
-    // Calculate overall compression ratio
-    double compressionRatio = totalBytes / static_cast<double>(totalCompressedBytes);
-
-    // Calculate compression and decompression throughput in MB/s
-    double compressionThroughputMBps = totalBytes / (totalCompressionTimeMs * 1e-3) / (1024 * 1024);
-    double decompressionThroughputMBps = totalBytes / (totalDecompressionTimeMs * 1e-3) / (1024 * 1024);
-
-    // Calculate MSE and PSNR
-    double mse = 0.0;
-    if (decompressedData.size() == data.size()) {
-        mse = std::inner_product(data.begin(), data.end(), decompressedData.begin(), 0.0, 
-            std::plus<>(),
-            [](float a, float b) { return (a - b) * (a - b); }
-        ) / data.size();
-    } else {
-        std::cerr << "Warning: Decompressed data size does not match original data size. MSE and PSNR will be set to NaN." << std::endl;
-        mse = std::nan("");
+    std::cout << timeMessage(std::format(
+        "Running pipelined benchmark for compressor '{}' with chunkSize {} bytes and {} buffers in flight",
+        compressor_->toString(), chunkSize_, queueDepth)
+    ) << std::endl;
+
+    // Busy time is measured with clock_, idle and end-to-end time on the wall clock
+    using Clock = std::chrono::steady_clock;
+
+    // A slot carries one chunk through every stage and is then recycled to the reader
+    struct PipelineSlot {
+        std::vector<T> chunk;
+        CompressedData compressed;
+        std::vector<T> decompressed;
+    };
+
+    size_t elementsPerChunk = chunkSize_ / sizeof(T);
+    std::vector<PipelineSlot> slots(queueDepth);
+    for (PipelineSlot& slot : slots) {
+        slot.chunk.reserve(elementsPerChunk);
+        slot.decompressed.resize(elementsPerChunk);
+        slot.compressed.data.resize(compressor_->compressBound(elementsPerChunk));
     }
 
-    // Calculate as 20log_10(MAX_I - 10log_10(MSE))
-    double valueRange = *std::max_element(data.begin(), data.end()) - *std::min_element(data.begin(), data.end());
-    double psnr = (mse > 0.0) ? 20.0 * std::log10(valueRange - 10.0 * std::log10(mse)) : std::nan("");
+    // Queues hold every slot plus the null end-of-stream marker, so pushes never fail
+    using SlotQueue = SPSCQueue<PipelineSlot*>;
+    SlotQueue freeSlots(queueDepth + 1);
+    SlotQueue toCompress(queueDepth + 1);
+    SlotQueue toDecompress(queueDepth + 1);
+    SlotQueue toMetrics(queueDepth + 1);
+    for (PipelineSlot& slot : slots) {
+        freeSlots.push(&slot);
+    }
+
+    enum Stage { Read, Compress, Decompress, Metrics, NumStages };
+    std::array<StageTiming, NumStages> timings{{{"read"}, {"compress"}, {"decompress"}, {"metrics"}}};
+    std::array<std::exception_ptr, NumStages> stageErrors{};
+    std::atomic<bool> failed{false};
 
-    // Calculate mean and max relative and absolute error
-    std::vector<double> absErrors;
-    std::vector<double> relErrors;
-    if (decompressedData.size() == data.size()) {
-        absErrors.resize(data.size());
-        relErrors.resize(data.size());
-        for (size_t i = 0; i < data.size(); ++i) {
-            absErrors[i] = std::abs(data[i] - decompressedData[i]);
-            relErrors[i] = (data[i] != 0.0f) ? absErrors[i] * 100.0 / std::abs(data[i]) : 0.0;
+    // Wait for the next slot, charging the wait to the stage's idle time, on the wall
+    // clock whatever clock_ is: the wait spins, so its CPU time is not idle time.
+    // Returns null at end of stream or when another stage has failed.
+    auto waitPop = [&failed](SlotQueue& queue, StageTiming& timing) {
+        auto start = Clock::now();
+        PipelineSlot* slot = nullptr;
+        while (!queue.pop(slot)) {
+            if (failed.load(std::memory_order_relaxed)) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        timing.idleMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        return slot;
+    };
+
+    auto push = [](SlotQueue& queue, PipelineSlot* slot) {
+        while (!queue.push(slot)) {
+            std::this_thread::yield();
         }
-    } else {
-        absErrors = {std::nan("")};
-        relErrors = {std::nan("")};
-    }
-
-    double meanAbsError = (absErrors.size() > 0) ? std::accumulate(absErrors.begin(), absErrors.end(), 0.0) / absErrors.size() : std::nan("");
-    double maxAbsError = (absErrors.size() > 0) ? *std::max_element(absErrors.begin(), absErrors.end()) : std::nan("");
-    double meanRelError = (relErrors.size() > 0) ? std::accumulate(relErrors.begin(), relErrors.end(), 0.0) / relErrors.size() : std::nan("");
-    double maxRelError = (relErrors.size() > 0) ? *std::max_element(relErrors.begin(), relErrors.end()) : std::nan("");
-
-    // Calculate distribution metrics (KL divergence, JS divergence, Wasserstein distance, KS statistic)
-    // double klDiv = computeKLDivergence(data, decompressedData);
-    // double jsDiv = computeJSDivergence(data, decompressedData);
-    // double wassersteinDist = computeWassersteinDistance(data, decompressedData);
-    // double ksStat = computeKSStatistic(data, decompressedData);
-
-    // Return results
-    return {
-        .decompressedData = returnDecompressed ? decompressedData : std::vector<float>{},
-        .compressionThroughputMBps = compressionThroughputMBps,
-        .decompressionThroughputMBps = decompressionThroughputMBps,
-        .compressionRatio = compressionRatio,
-        .MSE = mse,
-        .PSNR = psnr,
-        .meanRelError = meanRelError,
-        .maxRelError = maxRelError,
-        .meanAbsError = meanAbsError,
-        .maxAbsError = maxAbsError
     };
+
+    // Run one stage on its own thread; an exception stops every other stage
+    auto launch = [&](Stage stage, auto body) {
+        return std::jthread([&, stage, body]() {
+            try {
+                body(timings[stage]);
+            } catch (...) {
+                stageErrors[stage] = std::current_exception();
+                failed = true;
+            }
+        });
+    };
+
+    // Compression and decompression overlap, so each stage gets its own compressor
+    std::shared_ptr<Compressor<T>> decompressor = makeCompressor<T>(compressorName_, compressorOptions_);
+
+    size_t numChunks = 0;
+    size_t totalBytes = 0;
+    size_t totalCompressedBytes = 0;
+    ErrorAccumulator<T> errors;
+
+    auto startPipeline = Clock::now();
+    {
+        std::array<std::jthread, NumStages> stages{
+            launch(Read, [&](StageTiming& timing) {
+                while (PipelineSlot* slot = waitPop(freeSlots, timing)) {
+                    double start = clockMs(clock_);
+                    bool more = nextChunk(slot->chunk);
+                    timing.busyMs += clockMs(clock_) - start;
+                    if (!more) {
+                        break;
+                    }
+                    push(toCompress, slot);
+                }
+                push(toCompress, nullptr);
+            }),
+            launch(Compress, [&](StageTiming& timing) {
+                while (PipelineSlot* slot = waitPop(toCompress, timing)) {
+                    double start = clockMs(clock_);
+                    compressor_->compress(slot->chunk, slot->compressed);
+                    timing.busyMs += clockMs(clock_) - start;
+                    push(toDecompress, slot);
+                }
+                push(toDecompress, nullptr);
+            }),
+            launch(Decompress, [&](StageTiming& timing) {
+                while (PipelineSlot* slot = waitPop(toDecompress, timing)) {
+                    if (slot->decompressed.size() < slot->chunk.size()) {
+                        slot->decompressed.resize(slot->chunk.size());
+                    }
+                    double start = clockMs(clock_);
+                    decompressor->decompress(slot->compressed, slot->decompressed);
+                    timing.busyMs += clockMs(clock_) - start;
+                    push(toMetrics, slot);
+                }
+                push(toMetrics, nullptr);
+            }),
+            launch(Metrics, [&](StageTiming& timing) {
+                while (PipelineSlot* slot = waitPop(toMetrics, timing)) {
+                    double start = clockMs(clock_);
+                    numChunks += 1;
+                    totalBytes += slot->chunk.size() * sizeof(T);
+                    totalCompressedBytes += slot->compressed.numBytes;
+                    errors.update(slot->chunk, std::span<const T>{slot->decompressed.data(), slot->chunk.size()});
+                    timing.busyMs += clockMs(clock_) - start;
+                    push(freeSlots, slot);
+                }
+            })
+        };
+    }
+    auto endPipeline = Clock::now();
+
+    for (const std::exception_ptr& error : stageErrors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    BenchmarkResult result;
+    result.numChunks = numChunks;
+    result.clock = timingClockName(clock_);
+    result.wallTimeMs = std::chrono::duration<double, std::milli>(endPipeline - startPipeline).count();
+    result.stageTimings.assign(timings.begin(), timings.end());
+    result.compressionThroughputMBps = throughputMBps(totalBytes, timings[Compress].busyMs);
+    result.decompressionThroughputMBps = throughputMBps(totalBytes, timings[Decompress].busyMs);
+    result.threadCompressionThroughputMBps = {result.compressionThroughputMBps};
+    result.threadDecompressionThroughputMBps = {result.decompressionThroughputMBps};
+    result.compressionRatio = totalBytes / static_cast<double>(totalCompressedBytes);
+    fillErrorMetrics(errors, result);
+
+    for (const StageTiming& timing : timings) {
+        std::cout << timeMessage(std::format(
+            "Stage '{}': busy {:.1f} ms, idle {:.1f} ms", timing.stage, timing.busyMs, timing.idleMs)
+        ) << std::endl;
+    }
+    std::cout << timeMessage(std::format("Pipeline finished in {:.1f} ms", result.wallTimeMs)) << std::endl;
+
+    return result;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::setChunkBoundaries(std::vector<size_t> boundaries) {
+    if (!boundaries.empty()) {
+        if (boundaries.front() != 0 || !std::is_sorted(boundaries.begin(), boundaries.end())) {
+            throw std::invalid_argument("Chunk boundaries must start at 0 and be sorted");
+        }
+    }
+    chunkBoundaries_ = std::move(boundaries);
+}
+
+template <typename T>
+std::vector<size_t> CompressorBenchmark<T>::chunkBoundaries(size_t numValues) const {
+    if (chunkBoundaries_.empty()) {
+        return fixedChunkBoundaries(numValues, std::max<size_t>(chunkSize_ / sizeof(T), 1));
+    }
+    if (chunkBoundaries_.back() != numValues) {
+        throw std::invalid_argument(std::format(
+            "Chunk boundaries cover {} values but data has {}", chunkBoundaries_.back(), numValues));
+    }
+    return chunkBoundaries_;
+}
+
+template <typename T>
+size_t CompressorBenchmark<T>::runSerialChunks(std::span<const T> data, std::span<const size_t> boundaries,
+                                            std::span<T> decompressedData, std::vector<double>& compressionTrials,
+                                            std::vector<double>& decompressionTrials, ErrorAccumulator<T>& errors,
+                                            BenchmarkResult& result) {
+    size_t totalBytes = data.size() * sizeof(T);
+    size_t numChunks = boundaries.size() - 1;
+    size_t totalCompressedBytes = 0;
+
+    // The compressed buffer fits the largest chunk and is reused by every chunk of every run
+    size_t maxChunkElements = 0;
+    for (size_t chunkInx = 0; chunkInx < numChunks; ++chunkInx) {
+        maxChunkElements = std::max(maxChunkElements, boundaries[chunkInx + 1] - boundaries[chunkInx]);
+    }
+    CompressedData compressedChunk;
+    compressedChunk.data.resize(compressor_->compressBound(maxChunkElements));
+
+    std::optional<PerfCounterGroup> perf;
+    if (perfCounters_) {
+        perf.emplace();
+    }
+
+    int numRuns = warmupRuns_ + trials_;
+    for (int runInx = 0; runInx < numRuns; ++runInx) {
+        bool lastRun = (runInx == numRuns - 1);
+        bool counted = perf && perf->available() && runInx >= warmupRuns_;
+
+        // Set up accumulators
+        double totalCompressionTimeMs = 0.0;
+        double totalDecompressionTimeMs = 0.0;
+        totalCompressedBytes = 0;
+
+        for (size_t chunkInx = 0; chunkInx < numChunks; ++chunkInx) {
+            // Get next chunk as a view into data
+            size_t offset = boundaries[chunkInx];
+            size_t numElements = boundaries[chunkInx + 1] - offset;
+            std::span<const T> chunk = data.subspan(offset, numElements);
+            std::span<T> decompressedChunk{decompressedData.data() + offset, numElements};
+
+            // Compress chunk; counters are read outside the timed region
+            PerfCounts startCounts = counted ? perf->sample() : PerfCounts{};
+            double startCompression = clockMs(clock_);
+            compressor_->compress(chunk, compressedChunk);
+            double endCompression = clockMs(clock_);
+            if (counted) {
+                result.compressionPerf += PerfCounterGroup::delta(startCounts, perf->sample(), chunk.size_bytes());
+            }
+
+            // Record compression time and compressed size
+            totalCompressionTimeMs += endCompression - startCompression;
+            totalCompressedBytes += compressedChunk.numBytes;
+
+            // Decompress chunk directly into its slot of the output
+            startCounts = counted ? perf->sample() : PerfCounts{};
+            double startDecompression = clockMs(clock_);
+            compressor_->decompress(compressedChunk, decompressedChunk);
+            double endDecompression = clockMs(clock_);
+            if (counted) {
+                result.decompressionPerf += PerfCounterGroup::delta(startCounts, perf->sample(), chunk.size_bytes());
+            }
+
+            // Record decompression time
+            totalDecompressionTimeMs += endDecompression - startDecompression;
+
+            if (runInx >= warmupRuns_) {
+                result.compressionLatency.record(toNs(endCompression - startCompression));
+                result.decompressionLatency.record(toNs(endDecompression - startDecompression));
+            }
+
+            // Accumulate errors while both chunks are still in cache (once, in the last run),
+            // unless they are accumulated in parallel afterwards
+            if (lastRun) {
+                if (errorThreads_ == 1) {
+                    double chunkMaxAbsError = errors.update(chunk, decompressedChunk);
+                    if (chunkRecords_) {
+                        result.chunkRecords[chunkInx].maxAbsError = chunkMaxAbsError;
+                    }
+                }
+                if (chunkRecords_) {
+                    ChunkRecord& record = result.chunkRecords[chunkInx];
+                    record.compressedBytes = compressedChunk.numBytes;
+                    record.compressNs = toNs(endCompression - startCompression);
+                    record.decompressNs = toNs(endDecompression - startDecompression);
+                }
+            }
+        }
+
+        // Calculate compression and decompression throughput in MB/s
+        if (runInx >= warmupRuns_) {
+            compressionTrials.push_back(throughputMBps(totalBytes, totalCompressionTimeMs));
+            decompressionTrials.push_back(throughputMBps(totalBytes, totalDecompressionTimeMs));
+        }
+    }
+
+    return totalCompressedBytes;
+}
+
+template <typename T>
+void CompressorBenchmark<T>::accumulateErrorsParallel(std::span<const T> data, std::span<const size_t> boundaries,
+                                                      std::span<const T> decompressedData, ErrorAccumulator<T>& errors,
+                                                      BenchmarkResult& result) {
+    size_t numChunks = boundaries.size() - 1;
+    int numWorkers = static_cast<int>(std::clamp<size_t>(numChunks, 1, errorThreads_));
+    std::vector<ErrorAccumulator<T>> workerErrors(numWorkers, ErrorAccumulator<T>(exactDistributions_));
+
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < numWorkers; ++t) {
+            threads.emplace_back([&, t]() {
+                for (size_t chunkInx = numChunks * t / numWorkers; chunkInx < numChunks * (t + 1) / numWorkers; ++chunkInx) {
+                    size_t begin = boundaries[chunkInx];
+                    size_t end = boundaries[chunkInx + 1];
+                    double chunkMaxAbsError = workerErrors[t].update(data.subspan(begin, end - begin),
+                                                                     decompressedData.subspan(begin, end - begin));
+                    if (chunkRecords_) {
+                        result.chunkRecords[chunkInx].maxAbsError = chunkMaxAbsError;
+                    }
+                }
+            });
+        }
+    }
+
+    for (const ErrorAccumulator<T>& worker : workerErrors) {
+        errors.merge(worker);
+    }
 }
 
-// double CompressorBenchmark::computeKLDivergence(const std::vector<float>& original, const std::vector<float>& compressed) {
-//     if (original.size() != compressed.size()) {
-//         throw std::invalid_argument("Original and compressed data must have the same size for KL divergence calculation.");
-//     }
+template <typename T>
+size_t CompressorBenchmark<T>::runParallelChunks(std::span<const T> data, std::span<const size_t> boundaries,
+                                              std::span<T> decompressedData, BenchmarkResult& result,
+                                              std::vector<double>& compressionTrials, std::vector<double>& decompressionTrials,
+                                              ErrorAccumulator<T>& errors) {
+    size_t totalBytes = data.size() * sizeof(T);
+    size_t numChunks = boundaries.size() - 1;
+    int numRuns = warmupRuns_ + trials_;
+
+    // Per-thread state, sized up front so workers never touch shared containers
+    struct WorkerState {
+        std::shared_ptr<Compressor<T>> compressor;
+        std::vector<CompressedData> compressedChunks;
+        size_t firstChunk{};
+        size_t numBytes{};
+        size_t compressedBytes{};
+        double compressionTimeMs{};         // Current run's busy time in each phase
+        double decompressionTimeMs{};
+        std::vector<double> runCompressionTimeMs;   // Busy time of every run, read by the main thread
+        std::vector<double> runDecompressionTimeMs;
+        std::vector<double> compressionTrials;      // Per-thread throughput of each trial
+        std::vector<double> decompressionTrials;
+        ErrorAccumulator<T> errors;
+        PerfCounts compressionPerf;                 // Hardware counts over the worker's trials
+        PerfCounts decompressionPerf;
+        LatencyHistogram compressionLatency;        // Per-chunk latencies over the worker's trials
+        LatencyHistogram decompressionLatency;
+    };
+
+    // A worker without chunks would report 0 bytes in 0 ms, so there are never more workers than chunks
+    int numWorkers = static_cast<int>(std::clamp<size_t>(numChunks, 1, numThreads_));
+    if (numWorkers < numThreads_) {
+        std::cout << timeMessage(std::format("Only {} chunk(s), running on {} of {} thread(s)", numChunks, numWorkers, numThreads_)) << std::endl;
+    }
+    result.numThreads = numWorkers;
+    std::vector<WorkerState> workers(numWorkers);
+
+    // Split chunks into contiguous blocks, one per worker
+    for (int t = 0; t < numWorkers; ++t) {
+        WorkerState& worker = workers[t];
+        worker.compressor = makeCompressor<T>(compressorName_, compressorOptions_);
+        worker.errors = ErrorAccumulator<T>(exactDistributions_);
+        worker.runCompressionTimeMs.resize(numRuns);
+        worker.runDecompressionTimeMs.resize(numRuns);
+        worker.firstChunk = numChunks * t / numWorkers;
+        size_t lastChunk = numChunks * (t + 1) / numWorkers;
+        worker.compressedChunks.resize(lastChunk - worker.firstChunk);
+        for (size_t i = 0; i < worker.compressedChunks.size(); ++i) {
+            size_t chunkInx = worker.firstChunk + i;
+            worker.compressedChunks[i].data.resize(
+                worker.compressor->compressBound(boundaries[chunkInx + 1] - boundaries[chunkInx]));
+        }
+    }
+
+    // In every run, workers and the main thread meet at the barrier before compression,
+    // between compression and decompression, and after decompression, so the main thread
+    // can time each phase as a whole. Workers and buffers persist across runs, so warmup
+    // runs warm the same compressors the trials use.
+    std::barrier sync(numWorkers + 1);
+
+    auto work = [&](WorkerState& worker) {
+        // Counters count the thread that opens them
+        std::optional<PerfCounterGroup> perf;
+        if (perfCounters_) {
+            perf.emplace();
+        }
+
+        for (int runInx = 0; runInx < numRuns; ++runInx) {
+            bool counted = perf && perf->available() && runInx >= warmupRuns_;
+            bool measured = runInx >= warmupRuns_;
+            bool recorded = chunkRecords_ && runInx == numRuns - 1;
+            worker.numBytes = 0;
+            worker.compressedBytes = 0;
+            worker.compressionTimeMs = 0.0;
+            worker.decompressionTimeMs = 0.0;
+
+            sync.arrive_and_wait();
 
-//     double klDiv = 0.0;
-// }
+            for (size_t i = 0; i < worker.compressedChunks.size(); ++i) {
+                size_t chunkInx = worker.firstChunk + i;
+                std::span<const T> chunk = data.subspan(boundaries[chunkInx], boundaries[chunkInx + 1] - boundaries[chunkInx]);
 
-// double CompressorBenchmark::computeJSDivergence(const std::vector<float>& original, const std::vector<float>& compressed) {
-//     // Placeholder implementation
-//     return 0.0;
-// }
+                PerfCounts startCounts = counted ? perf->sample() : PerfCounts{};
+                double startCompression = clockMs(clock_);
+                worker.compressor->compress(chunk, worker.compressedChunks[i]);
+                double endCompression = clockMs(clock_);
+                if (counted) {
+                    worker.compressionPerf += PerfCounterGroup::delta(startCounts, perf->sample(), chunk.size_bytes());
+                }
+
+                worker.compressionTimeMs += endCompression - startCompression;
+                worker.compressedBytes += worker.compressedChunks[i].numBytes;
+                worker.numBytes += chunk.size() * sizeof(T);
+                if (measured) {
+                    worker.compressionLatency.record(toNs(endCompression - startCompression));
+                }
+                if (recorded) {
+                    result.chunkRecords[chunkInx].compressedBytes = worker.compressedChunks[i].numBytes;
+                    result.chunkRecords[chunkInx].compressNs = toNs(endCompression - startCompression);
+                }
+            }
+
+            sync.arrive_and_wait();
+
+            for (size_t i = 0; i < worker.compressedChunks.size(); ++i) {
+                const CompressedData& compressed = worker.compressedChunks[i];
+                size_t offset = boundaries[worker.firstChunk + i];
+
+                PerfCounts startCounts = counted ? perf->sample() : PerfCounts{};
+                double startDecompression = clockMs(clock_);
+                worker.compressor->decompress(compressed, decompressedData.subspan(offset, compressed.numElements));
+                double endDecompression = clockMs(clock_);
+                if (counted) {
+                    worker.decompressionPerf += PerfCounterGroup::delta(startCounts, perf->sample(), compressed.numElements * sizeof(T));
+                }
+
+                worker.decompressionTimeMs += endDecompression - startDecompression;
+                if (measured) {
+                    worker.decompressionLatency.record(toNs(endDecompression - startDecompression));
+                }
+                if (recorded) {
+                    result.chunkRecords[worker.firstChunk + i].decompressNs = toNs(endDecompression - startDecompression);
+                }
+            }
+
+            // Published before the barrier to slots of this run only, as the next run
+            // resets the running times while the main thread may still be reading
+            worker.runCompressionTimeMs[runInx] = worker.compressionTimeMs;
+            worker.runDecompressionTimeMs[runInx] = worker.decompressionTimeMs;
+
+            sync.arrive_and_wait();
+
+            if (runInx >= warmupRuns_) {
+                worker.compressionTrials.push_back(throughputMBps(worker.numBytes, worker.compressionTimeMs));
+                worker.decompressionTrials.push_back(throughputMBps(worker.numBytes, worker.decompressionTimeMs));
+            }
+        }
+
+        // Each worker accumulates the errors of its own chunks, outside the timed phases
+        for (size_t i = 0; i < worker.compressedChunks.size(); ++i) {
+            size_t chunkInx = worker.firstChunk + i;
+            size_t begin = boundaries[chunkInx];
+            size_t end = boundaries[chunkInx + 1];
+            double chunkMaxAbsError = worker.errors.update(data.subspan(begin, end - begin),
+                                                           decompressedData.subspan(begin, end - begin));
+            if (chunkRecords_) {
+                result.chunkRecords[chunkInx].maxAbsError = chunkMaxAbsError;
+            }
+        }
+    };
+
+    std::vector<std::jthread> threads;
+    threads.reserve(numWorkers);
+    for (WorkerState& worker : workers) {
+        threads.emplace_back(work, std::ref(worker));
+    }
+
+    for (int runInx = 0; runInx < numRuns; ++runInx) {
+        sync.arrive_and_wait();
+        auto startCompression = std::chrono::steady_clock::now();
+        sync.arrive_and_wait();
+        auto endCompression = std::chrono::steady_clock::now();
+        sync.arrive_and_wait();
+        auto endDecompression = std::chrono::steady_clock::now();
+
+        if (runInx < warmupRuns_) {
+            continue;
+        }
+
+        // Aggregate throughput over the wall-clock time of each phase, or over the
+        // busiest worker's CPU time in this run with the CPU clock
+        double compressionMs = std::chrono::duration<double, std::milli>(endCompression - startCompression).count();
+        double decompressionMs = std::chrono::duration<double, std::milli>(endDecompression - endCompression).count();
+        if (clock_ == TimingClock::ThreadCPU) {
+            compressionMs = 0.0;
+            decompressionMs = 0.0;
+            for (const WorkerState& worker : workers) {
+                compressionMs = std::max(compressionMs, worker.runCompressionTimeMs[runInx]);
+                decompressionMs = std::max(decompressionMs, worker.runDecompressionTimeMs[runInx]);
+            }
+        }
+        compressionTrials.push_back(throughputMBps(totalBytes, compressionMs));
+        decompressionTrials.push_back(throughputMBps(totalBytes, decompressionMs));
+    }
+    threads.clear();
+
+    // Per-thread throughput over each worker's own busy time (median over the trials)
+    size_t totalCompressedBytes = 0;
+    for (const WorkerState& worker : workers) {
+        result.threadCompressionThroughputMBps.push_back(summarizeThroughputs(worker.compressionTrials).median);
+        result.threadDecompressionThroughputMBps.push_back(summarizeThroughputs(worker.decompressionTrials).median);
+        totalCompressedBytes += worker.compressedBytes;
+        errors.merge(worker.errors);
+        result.compressionPerf += worker.compressionPerf;
+        result.decompressionPerf += worker.decompressionPerf;
+        result.compressionLatency.merge(worker.compressionLatency);
+        result.decompressionLatency.merge(worker.decompressionLatency);
+    }
+
+    return totalCompressedBytes;
+}
 
-// double CompressorBenchmark::computeWassersteinDistance(const std::vector<float>& original, const std::vector<float>& compressed) {
-//     // Placeholder implementation
-//     return 0.0;
-// }
+template class CompressorBenchmark<float>;
+template class CompressorBenchmark<double>;
+template class CompressorBenchmark<int32_t>;
+template class CompressorBenchmark<char>;
 
-// double CompressorBenchmark::computeKSStatistic(const std::vector<float>& original, const std::vector<float>& compressed) {
-//     // Placeholder implementation
-//     return 0.0;
-// }
\ No newline at end of file
+template std::shared_ptr<Compressor<float>> makeCompressor<float>(const std::string&, const std::map<std::string, std::string>&);
+template std::shared_ptr<Compressor<double>> makeCompressor<double>(const std::string&, const std::map<std::string, std::string>&);
+template std::shared_ptr<Compressor<int32_t>> makeCompressor<int32_t>(const std::string&, const std::map<std::string, std::string>&);
+template std::shared_ptr<Compressor<char>> makeCompressor<char>(const std::string&, const std::map<std::string, std::string>&);
@@ -5,25 +5,65 @@
  */
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 #include <memory>
 #include <map>
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <optional>
 
 #include "Compressor.hpp"
+#include "ErrorAccumulator.hpp"
+#include "PerfCounters.hpp"
+#include "Timing.hpp"
 #include "TruncCompressor.hpp"
+#include "RootCompressor.hpp"
 #include "SZ3Compressor.hpp"
 #include "../utils/utils.hpp"
 
-struct BenchmarkResult {
-    std::vector<float> decompressedData{};
+struct StageTiming {
+    std::string stage{};
+    double busyMs{};        // Time spent doing the stage's own work, on the benchmark's clock
+    double idleMs{};        // Wall-clock time spent waiting for input from the previous stage
+};
+
+struct ChunkRecord {
+    size_t chunkIndex{};
+    size_t inputBytes{};
+    size_t compressedBytes{};
+    uint64_t compressNs{};
+    uint64_t decompressNs{};
+    double maxAbsError{};
+};
 
+struct BenchmarkResult {
+    // Median over trials; with more than one thread these are aggregate throughputs
     double compressionThroughputMBps{};
     double decompressionThroughputMBps{};
 
+    std::string clock{"wall"};                  // Clock the throughputs were timed with
+    int warmupRuns{};                           // Untimed runs before the trials
+    ThroughputStats compressionStats{};         // Spread of compression throughput over the trials of run()
+    ThroughputStats decompressionStats{};
+
+    PerfCounts compressionPerf{};               // Hardware counters over compress calls of all trials (if enabled)
+    PerfCounts decompressionPerf{};             // Hardware counters over decompress calls of all trials (if enabled)
+
+    LatencyHistogram compressionLatency{};      // Per-chunk compress latency over all trials of run()
+    LatencyHistogram decompressionLatency{};    // Per-chunk decompress latency over all trials of run()
+    std::vector<ChunkRecord> chunkRecords{};    // One record per chunk of run()'s last trial (if enabled)
+
+    int numThreads{1};                          // Worker threads used, at most one per chunk
+    size_t numChunks{};
+    std::vector<double> threadCompressionThroughputMBps{};      // Per-thread throughput over each thread's own busy time
+    std::vector<double> threadDecompressionThroughputMBps{};
+
+    double wallTimeMs{};                        // End-to-end time of the pipelined mode
+    std::vector<StageTiming> stageTimings{};    // Per-stage busy/idle time of the pipelined mode
+
     double compressionRatio{};
     double MSE{};
     double PSNR{};
@@ -35,12 +75,28 @@ struct BenchmarkResult {
     double JSdivergence{};
     double WassersteinDistance{};
     double KSstatistic{};
+    bool exactDistributions{};                  // Whether Wasserstein and KS are exact or histogram-based
 };
 
+/**
+ * @brief Create a compressor for element type T from its name and options.
+ * @param compressorName Name of the compressor ("BitTruncation", "SZ3" or "ROOT").
+ * @param compressorOptions Compressor-specific configuration options.
+ * @return Shared pointer to the new compressor.
+ * @throws std::invalid_argument if the compressor is unknown or does not support T.
+ */
+template <typename T>
+std::shared_ptr<Compressor<T>> makeCompressor(const std::string& compressorName,
+                                           const std::map<std::string, std::string>& compressorOptions);
+
 /**
  * @class CompressorBenchmark
  * @brief Class for running and recording benchmarks of data compressors.
+ *
+ * Instantiated for each column element type (float, double, int32_t and char), so
+ * chunk loops and error metrics are compiled for the concrete type.
  */
+template <typename T>
 class CompressorBenchmark {
 public:
     /**
@@ -49,32 +105,214 @@ public:
      */
     CompressorBenchmark(int chunkSize, const std::string& compressorName,
                         const std::map<std::string, std::string>& compressorOptions)
-        :  chunkSize_(chunkSize)
+        :  chunkSize_(chunkSize), compressorName_(compressorName), compressorOptions_(compressorOptions)
     {
-        if (compressorName == "BitTruncation") {
-            compressor_ = std::make_shared<TruncCompressor>(compressorOptions);
-        } else if (compressorName == "SZ3") {
-            compressor_ = std::make_shared<SZ3Compressor>(compressorOptions);
-        } else {
-            throw std::invalid_argument("Unknown compressor: " + compressorName);
-        }
+        compressor_ = makeCompressor<T>(compressorName, compressorOptions);
     }
 
+    /**
+     * @brief Set the number of worker threads used to compress chunks.
+     *
+     * With more than one thread, chunks are split into contiguous blocks across a pool
+     * of workers, each with its own compressor instance. All workers compress, then all
+     * workers decompress, so each phase gets its own wall-clock throughput.
+     */
+    void setNumThreads(int numThreads);
+    int getNumThreads() const;
+
+    /**
+     * @brief Set the number of untimed passes over the data run() makes before its trials.
+     *
+     * Warmup absorbs first-touch page faults of the output buffers, cold caches and the
+     * compressors' first allocations, so they do not end up in the measured throughput.
+     */
+    void setWarmupRuns(int warmupRuns);
+    int getWarmupRuns() const;
+
+    /**
+     * @brief Set the number of timed passes over the data run() makes (default 1).
+     *
+     * Throughputs are reported as the median over the trials, with their spread in
+     * BenchmarkResult::compressionStats and decompressionStats. Error metrics are taken
+     * from the last trial only.
+     */
+    void setTrials(int trials);
+    int getTrials() const;
+
+    /**
+     * @brief Set the clock compress and decompress calls are timed with in run() and
+     *        runStream(), and the clock of the stages' busy time in runPipeline()
+     *        (default wall clock).
+     *
+     * With the per-thread CPU clock and several threads, each phase lasts as long as the
+     * busiest worker's CPU time.
+     */
+    void setTimingClock(TimingClock clock);
+    TimingClock getTimingClock() const;
+
+    /**
+     * @brief Count hardware events (cycles, instructions, cache and branch misses) around
+     *        every compress and decompress call of run()'s trials.
+     *
+     * Each thread reads its own counters before and after each call, outside the timed
+     * region. Counts of all threads and trials are summed into BenchmarkResult::compressionPerf
+     * and decompressionPerf. If the host does not allow counting, a warning is printed
+     * once and the counts are left invalid.
+     */
+    void setPerfCounters(bool enabled);
+    bool getPerfCounters() const;
+
+    /**
+     * @brief Keep a record of every chunk of run()'s last trial in BenchmarkResult::chunkRecords.
+     *
+     * Records are preallocated for all chunks before the chunk loop and filled in place,
+     * so the loop still does not allocate. Latency histograms are kept regardless.
+     */
+    void setChunkRecords(bool enabled);
+    bool getChunkRecords() const;
+
+    /**
+     * @brief Set the number of threads that accumulate error metrics in single-threaded run()s.
+     *
+     * With one thread (the default), each chunk's errors are accumulated right after it is
+     * decompressed in the last trial, while both copies are in cache. With more, the errors
+     * are accumulated after the last trial by that many threads, each over a block of
+     * chunks, so expensive metrics run in parallel without sharing the machine with any
+     * timed call. Runs on several worker threads (setNumThreads()) accumulate errors per
+     * worker regardless.
+     */
+    void setErrorThreads(int errorThreads);
+    int getErrorThreads() const;
+
+    /**
+     * @brief Compute the Wasserstein distance and KS statistic of run() exactly (see
+     *        ErrorAccumulator), instead of from histograms.
+     *
+     * Costs two extra copies of the data, and a third while the sorted chunks are merged
+     * on max(setNumThreads(), setErrorThreads()) threads after the trials. runStream() and
+     * runPipeline() always use histograms, to keep memory bounded.
+     */
+    void setExactDistributions(bool enabled);
+    bool getExactDistributions() const;
+
+    /**
+     * @brief Use explicit chunk boundaries instead of fixed chunkSize chunks in run().
+     *
+     * Lets chunks follow entry, basket or cluster boundaries (see utils/column.hpp).
+     * An empty vector restores fixed-size chunks.
+     *
+     * @param boundaries Value offsets where each chunk starts, followed by the total
+     *                   number of values passed to run().
+     */
+    void setChunkBoundaries(std::vector<size_t> boundaries);
+
     /**
      * @brief Run the benchmark and record results.
      *
+     * Chunks are compressed directly from views into data; compressed and decompressed
+     * buffers are allocated once up front, so the chunk loop itself does not allocate.
+     *
      * @param data Input data to compress.
-     * @param returnDecompressed If true, return the decompressed data in the result.
+     * @param decompressed Optional buffer of data.size() elements receiving the decompressed
+     *                     data; if empty, a scratch buffer is used and discarded.
+     */
+    BenchmarkResult run(std::span<const T> data, std::span<T> decompressed = {});
+
+    /**
+     * @brief Run the benchmark on chunks pulled one at a time from a source.
+     *
+     * Only the current chunk and its compressed and decompressed copies are held in
+     * memory, and error metrics are accumulated chunk by chunk, so arbitrarily large
+     * inputs run in bounded memory. Chunk sizes are decided by the source. For the same
+     * reason the Wasserstein distance and KS statistic always come from histograms (see
+     * setExactDistributions()).
+     *
+     * @param nextChunk Callable that refills its argument with the next chunk and
+     *                  returns false once there is no more data.
      */
-    BenchmarkResult run(const std::vector<float>& data, bool returnDecompressed = false);
+    BenchmarkResult runStream(const std::function<bool(std::vector<T>&)>& nextChunk);
+
+    /**
+     * @brief Run the benchmark as an overlapped read -> compress -> decompress -> metrics pipeline.
+     *
+     * Each stage runs on its own thread. Stages hand chunk buffers to each other through
+     * bounded lock-free queues, and a fixed pool of queueDepth buffers is recycled from the
+     * metrics stage back to the reader, so memory stays bounded and nothing is allocated
+     * once the pool is warm. End-to-end time then approaches that of the slowest stage.
+     * As in runStream(), the Wasserstein distance and KS statistic come from histograms.
+     *
+     * @param nextChunk Reader stage: refills its argument with the next chunk and returns
+     *                  false once there is no more data.
+     * @param queueDepth Number of chunk buffers in flight between stages.
+     */
+    BenchmarkResult runPipeline(const std::function<bool(std::vector<T>&)>& nextChunk, size_t queueDepth = 8);
 
 
 private:
-    std::shared_ptr<Compressor> compressor_;    ///< Compressor to benchmark
+    std::shared_ptr<Compressor<T>> compressor_; ///< Compressor to benchmark
     int chunkSize_;                             ///< Size of chunks that get compressed
+    std::string compressorName_;                ///< Compressor name, used to build per-thread instances
+    std::map<std::string, std::string> compressorOptions_;     ///< Compressor options, used to build per-thread instances
+    int numThreads_{1};                         ///< Number of worker threads
+    int warmupRuns_{0};                         ///< Untimed passes before the trials
+    int trials_{1};                             ///< Timed passes
+    TimingClock clock_{TimingClock::Wall};      ///< Clock used to time chunks
+    bool perfCounters_{false};                  ///< Count hardware events around compression calls
+    bool chunkRecords_{false};                  ///< Record every chunk of the last trial
+    int errorThreads_{1};                       ///< Threads accumulating errors after single-threaded trials
+    bool exactDistributions_{false};            ///< Exact Wasserstein and KS in run()
+    std::vector<size_t> chunkBoundaries_;       ///< Explicit chunk boundaries (empty = fixed chunkSize chunks)
 
-    double computeKLDivergence(const std::vector<float>& original, const std::vector<float>& compressed);
-    double computeJSDivergence(const std::vector<float>& original, const std::vector<float>& compressed);
-    double computeWassersteinDistance(const std::vector<float>& original, const std::vector<float>& compressed);
-    double computeKSStatistic(const std::vector<float>& original, const std::vector<float>& compressed);
+    /**
+     * @brief Chunk boundaries to use for numValues values.
+     * @return Value offsets where each chunk starts, followed by numValues.
+     */
+    std::vector<size_t> chunkBoundaries(size_t numValues) const;
+
+    /**
+     * @brief Compress and decompress all chunks on the calling thread, warmupRuns_ + trials_ times.
+     * @param data Input data to compress.
+     * @param boundaries Chunk boundaries, as value offsets into data.
+     * @param decompressedData Output buffer (same size as data) receiving decompressed chunks.
+     * @param compressionTrials Receives the compression throughput of each trial.
+     * @param decompressionTrials Receives the decompression throughput of each trial.
+     * @param errors Accumulator receiving the errors of the last trial.
+     * @param result Result receiving latency histograms, chunk records and hardware counts.
+     * @return Total number of compressed bytes.
+     */
+    size_t runSerialChunks(std::span<const T> data, std::span<const size_t> boundaries,
+                           std::span<T> decompressedData, std::vector<double>& compressionTrials,
+                           std::vector<double>& decompressionTrials, ErrorAccumulator<T>& errors,
+                           BenchmarkResult& result);
+
+    /**
+     * @brief Accumulate the errors of all chunks on errorThreads_ threads, after the timed runs.
+     * @param data Input data.
+     * @param boundaries Chunk boundaries, as value offsets into data.
+     * @param decompressedData Decompressed data (same size as data).
+     * @param errors Accumulator receiving the merged errors of all chunks.
+     * @param result Result whose chunk records receive each chunk's max abs error.
+     */
+    void accumulateErrorsParallel(std::span<const T> data, std::span<const size_t> boundaries,
+                                  std::span<const T> decompressedData, ErrorAccumulator<T>& errors,
+                                  BenchmarkResult& result);
+
+    /**
+     * @brief Compress and decompress all chunks on a pool of numThreads_ workers, warmupRuns_ + trials_ times.
+     *
+     * With fewer chunks than numThreads_, only one worker per chunk is started.
+     * @param data Input data to compress.
+     * @param boundaries Chunk boundaries, as value offsets into data.
+     * @param decompressedData Output buffer (same size as data) receiving decompressed chunks.
+     * @param result Result receiving per-thread throughputs (median over the trials), latency
+     *               histograms, chunk records and hardware counts.
+     * @param compressionTrials Receives the aggregate compression throughput of each trial.
+     * @param decompressionTrials Receives the aggregate decompression throughput of each trial.
+     * @param errors Accumulator receiving the merged errors of all workers in the last trial.
+     * @return Total number of compressed bytes.
+     */
+    size_t runParallelChunks(std::span<const T> data, std::span<const size_t> boundaries,
+                             std::span<T> decompressedData, BenchmarkResult& result,
+                             std::vector<double>& compressionTrials, std::vector<double>& decompressionTrials,
+                             ErrorAccumulator<T>& errors);
 };
\ No newline at end of file
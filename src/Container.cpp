@@ -0,0 +1,362 @@
+/**
+ * @file Container.cpp
+ * @brief Implementation of the container writer and the memory-mapped container reader.
+ */
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Container.hpp"
+
+// Integers are written in native byte order, which the format fixes to little-endian
+static_assert(std::endian::native == std::endian::little, "Container files require a little-endian host");
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'O', 'O', 'T', 'L', 'E', 'S', 'S'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kTrailerSize = sizeof(uint64_t) + sizeof(kMagic);
+
+/**
+ * @brief Bounds-checked sequential reads from a mapped byte range.
+ */
+class ByteCursor {
+public:
+    ByteCursor(const uint8_t* data, size_t size, size_t position)
+        : data_(data), size_(size), position_(position) {}
+
+    template <typename U>
+    U read() {
+        U value;
+        std::memcpy(&value, take(sizeof(U)), sizeof(U));
+        return value;
+    }
+
+    std::string readString() {
+        uint32_t length = read<uint32_t>();
+        const uint8_t* bytes = take(length);
+        return std::string(reinterpret_cast<const char*>(bytes), length);
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_;
+
+    const uint8_t* take(size_t numBytes) {
+        if (numBytes > size_ - position_) {
+            throw std::runtime_error("Truncated container file");
+        }
+        const uint8_t* bytes = data_ + position_;
+        position_ += numBytes;
+        return bytes;
+    }
+};
+
+} // namespace
+
+ContainerWriter::ContainerWriter(const std::string& filename, const std::string& compressorName,
+                                 const std::map<std::string, std::string>& config)
+    : filename_(filename), file_(filename, std::ios::binary | std::ios::trunc)
+{
+    if (!file_) {
+        throw std::runtime_error("Failed to create container file '" + filename + "'");
+    }
+
+    write(kMagic, sizeof(kMagic));
+    writeValue<uint32_t>(kVersion);
+    writeString(compressorName);
+    writeValue<uint32_t>(static_cast<uint32_t>(config.size()));
+    for (const auto& [key, value] : config) {
+        writeString(key);
+        writeString(value);
+    }
+}
+
+ContainerWriter::~ContainerWriter() {
+    if (closed_) {
+        return;
+    }
+    try {
+        close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error closing container file '" << filename_ << "': " << e.what() << std::endl;
+    }
+}
+
+void ContainerWriter::beginBranch(const std::string& name, ElementType elementType) {
+    if (branchOpen_ || closed_) {
+        throw std::logic_error("Cannot begin a branch while another is open or after close()");
+    }
+    ContainerBranch& branch = branches_.emplace_back();
+    branch.name = name;
+    branch.elementType = elementType;
+    branchOpen_ = true;
+}
+
+void ContainerWriter::writeChunk(const CompressedData& compressed) {
+    if (!branchOpen_) {
+        throw std::logic_error("No branch is open");
+    }
+    ContainerBranch& branch = branches_.back();
+
+    ContainerChunk& chunk = branch.chunks.emplace_back();
+    chunk.position = position_;
+    chunk.numBytes = compressed.numBytes;
+    chunk.firstValue = branch.numValues;
+    chunk.numValues = compressed.numElements;
+    branch.numValues += compressed.numElements;
+
+    write(compressed.data.data(), compressed.numBytes);
+}
+
+void ContainerWriter::endBranch(std::span<const uint64_t> offsets) {
+    if (!branchOpen_) {
+        throw std::logic_error("No branch is open");
+    }
+    ContainerBranch& branch = branches_.back();
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != branch.numValues) {
+        throw std::invalid_argument(std::format(
+            "Entry offsets of branch '{}' do not cover the {} values written", branch.name, branch.numValues));
+    }
+
+    // Entries each chunk has values of; entry e holds values offsets[e] .. offsets[e + 1] - 1
+    for (ContainerChunk& chunk : branch.chunks) {
+        auto entryOf = [&offsets](uint64_t value) {
+            return static_cast<uint64_t>(std::upper_bound(offsets.begin(), offsets.end(), value) - offsets.begin() - 1);
+        };
+        chunk.firstEntry = entryOf(chunk.firstValue);
+        chunk.endEntry = (chunk.numValues > 0) ? entryOf(chunk.firstValue + chunk.numValues - 1) + 1 : chunk.firstEntry;
+    }
+
+    // Align the offsets so the reader can view them in place
+    static constexpr uint8_t kPadding[sizeof(uint64_t)] = {};
+    write(kPadding, (sizeof(uint64_t) - position_ % sizeof(uint64_t)) % sizeof(uint64_t));
+    branch.numEntries = offsets.size() - 1;
+    branch.offsetsPosition = position_;
+    write(offsets.data(), offsets.size_bytes());
+
+    branchOpen_ = false;
+}
+
+void ContainerWriter::close() {
+    if (closed_) {
+        return;
+    }
+    if (branchOpen_) {
+        throw std::logic_error("Cannot close the container while a branch is open");
+    }
+
+    uint64_t footerPosition = position_;
+    writeValue<uint32_t>(static_cast<uint32_t>(branches_.size()));
+    for (const ContainerBranch& branch : branches_) {
+        writeString(branch.name);
+        writeValue<uint32_t>(static_cast<uint32_t>(branch.elementType));
+        writeValue<uint64_t>(branch.numEntries);
+        writeValue<uint64_t>(branch.numValues);
+        writeValue<uint64_t>(branch.offsetsPosition);
+        writeValue<uint64_t>(branch.chunks.size());
+        for (const ContainerChunk& chunk : branch.chunks) {
+            writeValue<uint64_t>(chunk.position);
+            writeValue<uint64_t>(chunk.numBytes);
+            writeValue<uint64_t>(chunk.firstValue);
+            writeValue<uint64_t>(chunk.numValues);
+            writeValue<uint64_t>(chunk.firstEntry);
+            writeValue<uint64_t>(chunk.endEntry);
+        }
+    }
+    writeValue<uint64_t>(footerPosition);
+    write(kMagic, sizeof(kMagic));
+
+    file_.close();
+    if (!file_) {
+        throw std::runtime_error("Failed to write container file '" + filename_ + "'");
+    }
+    closed_ = true;
+}
+
+void ContainerWriter::write(const void* bytes, size_t numBytes) {
+    file_.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(numBytes));
+    if (!file_) {
+        throw std::runtime_error("Failed to write container file '" + filename_ + "'");
+    }
+    position_ += numBytes;
+}
+
+void ContainerWriter::writeString(const std::string& text) {
+    writeValue<uint32_t>(static_cast<uint32_t>(text.size()));
+    write(text.data(), text.size());
+}
+
+ContainerReader::ContainerReader(const std::string& filename)
+    : filename_(filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open container file '" + filename + "'");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(kMagic) + kTrailerSize)) {
+        ::close(fd);
+        throw std::runtime_error("Not a container file: '" + filename + "'");
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map container file '" + filename + "'");
+    }
+    data_ = static_cast<const uint8_t*>(mapping);
+
+    try {
+        if (std::memcmp(data_, kMagic, sizeof(kMagic)) != 0 ||
+            std::memcmp(data_ + size_ - sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) {
+            throw std::runtime_error("Not a container file: '" + filename + "'");
+        }
+
+        // Header
+        ByteCursor header(data_, size_, sizeof(kMagic));
+        uint32_t version = header.read<uint32_t>();
+        if (version != kVersion) {
+            throw std::runtime_error(std::format("Unsupported container version {} in '{}'", version, filename));
+        }
+        compressorName_ = header.readString();
+        uint32_t numOptions = header.read<uint32_t>();
+        for (uint32_t i = 0; i < numOptions; ++i) {
+            std::string key = header.readString();
+            config_[key] = header.readString();
+        }
+
+        // Footer, located by the trailer
+        ByteCursor trailer(data_, size_, size_ - kTrailerSize);
+        uint64_t footerPosition = trailer.read<uint64_t>();
+        if (footerPosition > size_ - kTrailerSize) {
+            throw std::runtime_error("Corrupt container footer position");
+        }
+        ByteCursor footer(data_, size_ - kTrailerSize, footerPosition);
+        uint32_t numBranches = footer.read<uint32_t>();
+        for (uint32_t i = 0; i < numBranches; ++i) {
+            ContainerBranch& branch = branches_.emplace_back();
+            branch.name = footer.readString();
+            branch.elementType = static_cast<ElementType>(footer.read<uint32_t>());
+            branch.numEntries = footer.read<uint64_t>();
+            branch.numValues = footer.read<uint64_t>();
+            branch.offsetsPosition = footer.read<uint64_t>();
+            uint64_t numChunks = footer.read<uint64_t>();
+            for (uint64_t c = 0; c < numChunks; ++c) {
+                ContainerChunk& chunk = branch.chunks.emplace_back();
+                chunk.position = footer.read<uint64_t>();
+                chunk.numBytes = footer.read<uint64_t>();
+                chunk.firstValue = footer.read<uint64_t>();
+                chunk.numValues = footer.read<uint64_t>();
+                chunk.firstEntry = footer.read<uint64_t>();
+                chunk.endEntry = footer.read<uint64_t>();
+                if (chunk.position > footerPosition || chunk.numBytes > footerPosition - chunk.position) {
+                    throw std::runtime_error("Corrupt container chunk index");
+                }
+            }
+            if (branch.offsetsPosition % sizeof(uint64_t) != 0 || branch.offsetsPosition > footerPosition ||
+                branch.numEntries + 1 > (footerPosition - branch.offsetsPosition) / sizeof(uint64_t)) {
+                throw std::runtime_error("Corrupt container offsets position");
+            }
+        }
+    } catch (...) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+        throw;
+    }
+}
+
+ContainerReader::~ContainerReader() {
+    ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+const ContainerBranch& ContainerReader::getBranch(const std::string& name) const {
+    auto it = std::find_if(branches_.begin(), branches_.end(), [&name](const ContainerBranch& branch) {
+        return branch.name == name;
+    });
+    if (it == branches_.end()) {
+        throw std::out_of_range("No branch '" + name + "' in container '" + filename_ + "'");
+    }
+    return *it;
+}
+
+std::span<const uint64_t> ContainerReader::getOffsets(const ContainerBranch& branch) const {
+    return {reinterpret_cast<const uint64_t*>(data_ + branch.offsetsPosition), branch.numEntries + 1};
+}
+
+std::span<const uint8_t> ContainerReader::getChunkBytes(const ContainerChunk& chunk) const {
+    return {data_ + chunk.position, chunk.numBytes};
+}
+
+template <typename T>
+JaggedColumn<T> ContainerReader::readEntries(const std::string& name, uint64_t firstEntry, uint64_t endEntry,
+                                             Compressor<T>& decompressor, size_t* chunksRead) const
+{
+    const ContainerBranch& branch = getBranch(name);
+    if (branch.elementType != elementTypeOf<T>()) {
+        throw std::invalid_argument(std::format("Branch '{}' holds {} values, not {}", name,
+                                                elementTypeName(branch.elementType), elementTypeName(elementTypeOf<T>())));
+    }
+    if (firstEntry > endEntry || endEntry > branch.numEntries) {
+        throw std::invalid_argument(std::format("Entries [{}, {}) are out of range for branch '{}' with {} entries",
+                                                firstEntry, endEntry, name, branch.numEntries));
+    }
+
+    std::span<const uint64_t> offsets = getOffsets(branch);
+    uint64_t beginValue = offsets[firstEntry];
+    uint64_t endValue = offsets[endEntry];
+
+    JaggedColumn<T> column;
+    column.values.resize(endValue - beginValue);
+    column.offsets.resize(endEntry - firstEntry + 1);
+    for (uint64_t entry = firstEntry; entry <= endEntry; ++entry) {
+        column.offsets[entry - firstEntry] = offsets[entry] - beginValue;
+    }
+
+    // First chunk that ends after the range begins; chunks are in value order
+    auto chunk = std::partition_point(branch.chunks.begin(), branch.chunks.end(), [beginValue](const ContainerChunk& c) {
+        return c.firstValue + c.numValues <= beginValue;
+    });
+
+    CompressedData compressed;
+    std::vector<T> scratch;
+    size_t numRead = 0;
+    for (; beginValue < endValue && chunk != branch.chunks.end() && chunk->firstValue < endValue; ++chunk) {
+        std::span<const uint8_t> bytes = getChunkBytes(*chunk);
+        compressed.data.assign(bytes.begin(), bytes.end());
+        compressed.numBytes = bytes.size();
+        compressed.numElements = chunk->numValues;
+
+        // Chunks inside the range decompress straight into the column, partial ones via scratch
+        uint64_t chunkEnd = chunk->firstValue + chunk->numValues;
+        if (chunk->firstValue >= beginValue && chunkEnd <= endValue) {
+            decompressor.decompress(compressed, std::span<T>(column.values).subspan(chunk->firstValue - beginValue, chunk->numValues));
+        } else {
+            scratch.resize(chunk->numValues);
+            decompressor.decompress(compressed, scratch);
+            uint64_t from = std::max(chunk->firstValue, beginValue);
+            uint64_t to = std::min(chunkEnd, endValue);
+            std::copy(scratch.begin() + (from - chunk->firstValue), scratch.begin() + (to - chunk->firstValue),
+                      column.values.begin() + (from - beginValue));
+        }
+        ++numRead;
+    }
+
+    if (chunksRead) {
+        *chunksRead = numRead;
+    }
+    return column;
+}
+
+template JaggedColumn<float> ContainerReader::readEntries<float>(const std::string&, uint64_t, uint64_t, Compressor<float>&, size_t*) const;
+template JaggedColumn<double> ContainerReader::readEntries<double>(const std::string&, uint64_t, uint64_t, Compressor<double>&, size_t*) const;
+template JaggedColumn<int32_t> ContainerReader::readEntries<int32_t>(const std::string&, uint64_t, uint64_t, Compressor<int32_t>&, size_t*) const;
+template JaggedColumn<char> ContainerReader::readEntries<char>(const std::string&, uint64_t, uint64_t, Compressor<char>&, size_t*) const;
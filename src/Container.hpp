@@ -0,0 +1,194 @@
+/**
+ * @file Container.hpp
+ * @brief ROOTLess container files: compressed chunks of several branches with an index for random access.
+ */
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Compressor.hpp"
+#include "../utils/column.hpp"
+
+/**
+ * @brief Index entry of one compressed chunk.
+ */
+struct ContainerChunk {
+    uint64_t position{};        // Byte offset of the compressed chunk in the file
+    uint64_t numBytes{};        // Compressed size, in bytes
+    uint64_t firstValue{};      // Index of the chunk's first value within the branch
+    uint64_t numValues{};       // Number of values in the chunk
+    uint64_t firstEntry{};      // First entry with values in the chunk
+    uint64_t endEntry{};        // One past the last entry with values in the chunk
+};
+
+/**
+ * @brief Index of one branch of a container.
+ */
+struct ContainerBranch {
+    std::string name{};
+    ElementType elementType{ElementType::Float};
+    uint64_t numEntries{};
+    uint64_t numValues{};
+    uint64_t offsetsPosition{};             // Byte offset of the numEntries + 1 entry offsets (uint64) in the file
+    std::vector<ContainerChunk> chunks{};   // Chunks in value order
+};
+
+/**
+ * @class ContainerWriter
+ * @brief Streams compressed chunks of one or more branches to a container file.
+ *
+ * Layout, all integers little-endian:
+ *
+ *     header:   "ROOTLESS" | uint32 version | compressor name | config entries
+ *     branch:   compressed chunks, back to back | uint64 entry offsets[numEntries + 1]
+ *     ...       (one block per branch, in the order written)
+ *     footer:   uint32 numBranches | per branch: name, element type, counts, offsets
+ *               position, uint64 numChunks and ContainerChunk fields per chunk
+ *     trailer:  uint64 footer position | "ROOTLESS"
+ *
+ * Strings are a uint32 length followed by their bytes; the compressor config is a uint32
+ * count followed by key and value strings, as returned by Compressor::getConfig(). Chunks
+ * are appended as soon as they are compressed, so only the index is held in memory until
+ * close() writes the footer.
+ */
+class ContainerWriter {
+public:
+    /**
+     * @brief Create a container file and write its header.
+     * @param filename Path to the container file, which is overwritten.
+     * @param compressorName Name of the compressor every chunk was compressed with (see makeCompressor()).
+     * @param config Compressor options, as returned by Compressor::getConfig().
+     * @throws std::runtime_error if the file cannot be created.
+     */
+    ContainerWriter(const std::string& filename, const std::string& compressorName,
+                    const std::map<std::string, std::string>& config);
+
+    /**
+     * @brief Close the container if close() was not called (errors are then only printed).
+     */
+    ~ContainerWriter();
+
+    /**
+     * @brief Start the chunk stream of a new branch.
+     * @throws std::logic_error if a branch is already open or the container is closed.
+     */
+    void beginBranch(const std::string& name, ElementType elementType);
+
+    /**
+     * @brief Append one compressed chunk to the open branch.
+     *
+     * Chunks must follow each other in value order, so the chunk's first value is the
+     * number of values written to the branch so far.
+     *
+     * @throws std::logic_error if no branch is open.
+     */
+    void writeChunk(const CompressedData& compressed);
+
+    /**
+     * @brief Finish the open branch, writing its entry offsets.
+     * @param offsets Entry offsets of the branch (see JaggedColumn::offsets); the last one
+     *                must equal the number of values written.
+     * @throws std::invalid_argument if the offsets do not match the chunks written.
+     */
+    void endBranch(std::span<const uint64_t> offsets);
+
+    /**
+     * @brief Write the footer and close the file.
+     * @throws std::logic_error if a branch is still open.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void close();
+
+    /** Bytes written so far. */
+    uint64_t bytesWritten() const { return position_; }
+
+private:
+    std::string filename_;
+    std::ofstream file_;
+    uint64_t position_{};                   ///< Bytes written so far
+    std::vector<ContainerBranch> branches_; ///< Index of the branches written so far
+    bool branchOpen_{false};
+    bool closed_{false};
+
+    void write(const void* bytes, size_t numBytes);
+    void writeString(const std::string& text);
+
+    template <typename U>
+    void writeValue(U value) {
+        write(&value, sizeof(U));
+    }
+};
+
+/**
+ * @class ContainerReader
+ * @brief Memory-maps a container file and decompresses entry ranges of its branches.
+ *
+ * Opening only parses the header and footer. readEntries() finds the chunks that overlap
+ * the requested entries in the index and decompresses only those, so the pages of every
+ * other chunk are never touched.
+ */
+class ContainerReader {
+public:
+    /**
+     * @brief Map a container file and read its index.
+     * @throws std::runtime_error if the file cannot be mapped or is not a valid container.
+     */
+    explicit ContainerReader(const std::string& filename);
+    ~ContainerReader();
+
+    ContainerReader(const ContainerReader&) = delete;
+    ContainerReader& operator=(const ContainerReader&) = delete;
+
+    /** Name of the compressor the chunks were compressed with. */
+    const std::string& getCompressorName() const { return compressorName_; }
+
+    /** Compressor options the chunks were compressed with. */
+    const std::map<std::string, std::string>& getConfig() const { return config_; }
+
+    /** Index of every branch, in the order they were written. */
+    const std::vector<ContainerBranch>& getBranches() const { return branches_; }
+
+    /**
+     * @brief Index of one branch.
+     * @throws std::out_of_range if the container has no such branch.
+     */
+    const ContainerBranch& getBranch(const std::string& name) const;
+
+    /**
+     * @brief Entry offsets of a branch, read in place from the mapping.
+     */
+    std::span<const uint64_t> getOffsets(const ContainerBranch& branch) const;
+
+    /**
+     * @brief Compressed bytes of a chunk, in place in the mapping.
+     */
+    std::span<const uint8_t> getChunkBytes(const ContainerChunk& chunk) const;
+
+    /**
+     * @brief Decompress a range of entries of a branch.
+     *
+     * @param name Branch name.
+     * @param firstEntry First entry to read.
+     * @param endEntry One past the last entry to read.
+     * @param decompressor Compressor matching getCompressorName() and getConfig() (see makeCompressor()).
+     * @param chunksRead If not null, receives the number of chunks decompressed.
+     * @return Column holding the requested entries only.
+     * @throws std::invalid_argument if T does not match the branch or the range is out of bounds.
+     */
+    template <typename T>
+    JaggedColumn<T> readEntries(const std::string& name, uint64_t firstEntry, uint64_t endEntry,
+                                Compressor<T>& decompressor, size_t* chunksRead = nullptr) const;
+
+private:
+    std::string filename_;
+    const uint8_t* data_{nullptr};          ///< Mapped file
+    size_t size_{};                         ///< Size of the mapping, in bytes
+    std::string compressorName_;
+    std::map<std::string, std::string> config_;
+    std::vector<ContainerBranch> branches_;
+};
@@ -0,0 +1,424 @@
+/**
+ * @file ErrorAccumulator.cpp
+ * @brief Implementation of the fused, lane-parallel error accumulation loop and the
+ *        histogram- and sample-based distribution metrics.
+ */
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#include "ErrorAccumulator.hpp"
+
+namespace {
+
+/**
+ * Independent partial sums and extrema per lane. Floating-point reductions may not be
+ * reordered by the compiler, so keeping one accumulator per lane is what lets the loop
+ * below vectorize without -ffast-math (4 doubles fill an AVX2 register).
+ */
+constexpr size_t kLanes = 4;
+
+constexpr size_t kNumBins = size_t{1} << ErrorAccumulator<float>::kHistogramBits;
+constexpr int kBinShift = 32 - ErrorAccumulator<float>::kHistogramBits;
+
+/**
+ * @brief Map a float's bit pattern to an unsigned key in the same order as the values.
+ *
+ * Positive floats get the sign bit set, negative floats have all bits flipped, so keys
+ * increase with the value from -inf to +inf.
+ */
+uint32_t orderedKey(float value) {
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/**
+ * @brief Inverse of orderedKey().
+ */
+float keyValue(uint32_t key) {
+    uint32_t bits = (key & 0x80000000u) ? (key ^ 0x80000000u) : ~key;
+    return std::bit_cast<float>(bits);
+}
+
+/**
+ * @brief Histogram bin of a value. Every type is binned through float, so bins have
+ *        the same relative width whatever the column type.
+ */
+template <typename T>
+size_t histogramBin(T value) {
+    return orderedKey(static_cast<float>(value)) >> kBinShift;
+}
+
+/**
+ * @brief Value at the middle of a bin.
+ */
+double binMidpoint(size_t bin) {
+    return keyValue(static_cast<uint32_t>(bin << kBinShift) | (1u << (kBinShift - 1)));
+}
+
+/**
+ * @brief Strict weak order of values for sorting samples: NaNs compare equal to each other
+ *        and greater than everything else, so they cannot break std::sort.
+ */
+template <typename T>
+bool sampleLess(T a, T b) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::isnan(b) ? !std::isnan(a) : a < b;
+    } else {
+        return a < b;
+    }
+}
+
+/**
+ * @brief Number of values of a among the first count values of merging a and b.
+ *
+ * Ties go to a, as in std::merge, so slices of the output split at these points merge
+ * independently into the same result.
+ */
+template <typename T>
+size_t mergeSplit(std::span<const T> a, std::span<const T> b, size_t count) {
+    size_t low = (count > b.size()) ? count - b.size() : 0;
+    size_t high = std::min(count, a.size());
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (!sampleLess(b[count - middle - 1], a[middle])) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Merge pairs of consecutive sorted runs of values into buffer, writing only
+ *        buffer[outputBegin, outputEnd).
+ * @param runEnds Offsets where the runs end; the last one is the number of values.
+ */
+template <typename T>
+void mergeRunPairs(const std::vector<T>& values, const std::vector<size_t>& runEnds, std::vector<T>& buffer,
+                   size_t outputBegin, size_t outputEnd) {
+    size_t begin = 0;
+    for (size_t run = 0; run < runEnds.size() && begin < outputEnd; run += 2) {
+        size_t middle = runEnds[run];
+        size_t end = (run + 1 < runEnds.size()) ? runEnds[run + 1] : middle;
+        if (end > outputBegin) {
+            std::span<const T> a(values.data() + begin, middle - begin);
+            std::span<const T> b(values.data() + middle, end - middle);
+            size_t first = std::max(outputBegin, begin) - begin;
+            size_t last = std::min(outputEnd, end) - begin;
+            size_t aFirst = mergeSplit(a, b, first);
+            size_t aLast = mergeSplit(a, b, last);
+            std::merge(a.begin() + aFirst, a.begin() + aLast, b.begin() + (first - aFirst), b.begin() + (last - aLast),
+                       buffer.begin() + begin + first, sampleLess<T>);
+        }
+        begin = end;
+    }
+}
+
+} // namespace
+
+template <typename T>
+double ErrorAccumulator<T>::update(std::span<const T> original, std::span<const T> decompressed) {
+    if (original.size() != decompressed.size()) {
+        throw std::invalid_argument("Original and decompressed chunks must have the same size");
+    }
+
+    std::array<double, kLanes> sumSquaredError{};
+    std::array<double, kLanes> sumAbsError{};
+    std::array<double, kLanes> maxAbsError{};
+    std::array<double, kLanes> sumRelError{};
+    std::array<double, kLanes> maxRelError{};
+    std::array<double, kLanes> minValue;
+    std::array<double, kLanes> maxValue;
+    minValue.fill(minValue_);
+    maxValue.fill(maxValue_);
+
+    // Branch-free body: dividing by infinity makes the relative error of a zero original 0
+    auto accumulate = [&](size_t lane, size_t i) {
+        double value = static_cast<double>(original[i]);
+        double absError = std::abs(value - static_cast<double>(decompressed[i]));
+        double magnitude = (value != 0.0) ? std::abs(value) : std::numeric_limits<double>::infinity();
+        double relError = absError * 100.0 / magnitude;
+        sumSquaredError[lane] += absError * absError;
+        sumAbsError[lane] += absError;
+        maxAbsError[lane] = (absError > maxAbsError[lane]) ? absError : maxAbsError[lane];
+        sumRelError[lane] += relError;
+        maxRelError[lane] = (relError > maxRelError[lane]) ? relError : maxRelError[lane];
+        minValue[lane] = (value < minValue[lane]) ? value : minValue[lane];
+        maxValue[lane] = (value > maxValue[lane]) ? value : maxValue[lane];
+    };
+
+    size_t n = original.size();
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            accumulate(lane, i + lane);
+        }
+    }
+    for (size_t lane = 0; i < n; ++i, ++lane) {
+        accumulate(lane, i);
+    }
+
+    // Fold the lanes into the running totals
+    double chunkMaxAbsError = 0.0;
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        sumSquaredError_ += sumSquaredError[lane];
+        sumAbsError_ += sumAbsError[lane];
+        chunkMaxAbsError = std::max(chunkMaxAbsError, maxAbsError[lane]);
+        sumRelError_ += sumRelError[lane];
+        maxRelError_ = std::max(maxRelError_, maxRelError[lane]);
+        minValue_ = std::min(minValue_, minValue[lane]);
+        maxValue_ = std::max(maxValue_, maxValue[lane]);
+    }
+    maxAbsError_ = std::max(maxAbsError_, chunkMaxAbsError);
+    count_ += n;
+
+    // Histograms in a second loop over the same chunk, which is still in cache
+    if (originalHistogram_.empty()) {
+        originalHistogram_.assign(kNumBins, 0);
+        decompressedHistogram_.assign(kNumBins, 0);
+    }
+    for (size_t j = 0; j < n; ++j) {
+        ++originalHistogram_[histogramBin(original[j])];
+        ++decompressedHistogram_[histogramBin(decompressed[j])];
+    }
+
+    // The chunk becomes one sorted run per side, sorted while it is still in cache
+    if (exactDistributions_ && n > 0) {
+        size_t begin = originalRuns_.size();
+        originalRuns_.insert(originalRuns_.end(), original.begin(), original.end());
+        decompressedRuns_.insert(decompressedRuns_.end(), decompressed.begin(), decompressed.end());
+        std::sort(originalRuns_.begin() + begin, originalRuns_.end(), sampleLess<T>);
+        std::sort(decompressedRuns_.begin() + begin, decompressedRuns_.end(), sampleLess<T>);
+        runEnds_.push_back(originalRuns_.size());
+    }
+    return chunkMaxAbsError;
+}
+
+template <typename T>
+void ErrorAccumulator<T>::merge(const ErrorAccumulator& other) {
+    if (exactDistributions_ != other.exactDistributions_) {
+        throw std::invalid_argument("Cannot merge error accumulators with and without exact distributions");
+    }
+
+    size_t offset = originalRuns_.size();
+    originalRuns_.insert(originalRuns_.end(), other.originalRuns_.begin(), other.originalRuns_.end());
+    decompressedRuns_.insert(decompressedRuns_.end(), other.decompressedRuns_.begin(), other.decompressedRuns_.end());
+    for (size_t end : other.runEnds_) {
+        runEnds_.push_back(offset + end);
+    }
+
+    count_ += other.count_;
+    sumSquaredError_ += other.sumSquaredError_;
+    sumAbsError_ += other.sumAbsError_;
+    maxAbsError_ = std::max(maxAbsError_, other.maxAbsError_);
+    sumRelError_ += other.sumRelError_;
+    maxRelError_ = std::max(maxRelError_, other.maxRelError_);
+    minValue_ = std::min(minValue_, other.minValue_);
+    maxValue_ = std::max(maxValue_, other.maxValue_);
+
+    if (other.originalHistogram_.empty()) {
+        return;
+    }
+    if (originalHistogram_.empty()) {
+        originalHistogram_ = other.originalHistogram_;
+        decompressedHistogram_ = other.decompressedHistogram_;
+        return;
+    }
+    for (size_t bin = 0; bin < kNumBins; ++bin) {
+        originalHistogram_[bin] += other.originalHistogram_[bin];
+        decompressedHistogram_[bin] += other.decompressedHistogram_[bin];
+    }
+}
+
+template <typename T>
+void ErrorAccumulator<T>::mergeRuns(int numThreads) const {
+    if (runEnds_.size() <= 1) {
+        return;
+    }
+
+    // Pairwise passes keep every merge sequential in memory, unlike a heap over all run
+    // heads, and split into equal slices however few pairs are left
+    size_t n = originalRuns_.size();
+    size_t numSlices = static_cast<size_t>(std::clamp<size_t>(numThreads, 1, std::max<size_t>(n, 1)));
+    std::vector<T> buffer(n);
+    auto mergePass = [&](std::vector<T>& values) {
+        {
+            std::vector<std::jthread> threads;
+            for (size_t slice = 1; slice < numSlices; ++slice) {
+                threads.emplace_back([&, slice]() {
+                    mergeRunPairs(values, runEnds_, buffer, n * slice / numSlices, n * (slice + 1) / numSlices);
+                });
+            }
+            mergeRunPairs(values, runEnds_, buffer, 0, n / numSlices);
+        }
+        values.swap(buffer);
+    };
+    while (runEnds_.size() > 1) {
+        mergePass(originalRuns_);
+        mergePass(decompressedRuns_);
+        std::vector<size_t> mergedEnds;
+        for (size_t run = 1; run < runEnds_.size(); run += 2) {
+            mergedEnds.push_back(runEnds_[run]);
+        }
+        if (runEnds_.size() % 2 == 1) {
+            mergedEnds.push_back(runEnds_.back());
+        }
+        runEnds_ = std::move(mergedEnds);
+    }
+}
+
+template <typename T>
+double ErrorAccumulator<T>::MSE() const {
+    return (count_ > 0) ? sumSquaredError_ / count_ : std::nan("");
+}
+
+template <typename T>
+double ErrorAccumulator<T>::PSNR() const {
+    double mse = MSE();
+    double valueRange = maxValue_ - minValue_;
+    return (mse > 0.0) ? 20.0 * std::log10(valueRange - 10.0 * std::log10(mse)) : std::nan("");
+}
+
+template <typename T>
+double ErrorAccumulator<T>::meanAbsError() const {
+    return (count_ > 0) ? sumAbsError_ / count_ : std::nan("");
+}
+
+template <typename T>
+double ErrorAccumulator<T>::maxAbsError() const {
+    return (count_ > 0) ? maxAbsError_ : std::nan("");
+}
+
+template <typename T>
+double ErrorAccumulator<T>::meanRelError() const {
+    return (count_ > 0) ? sumRelError_ / count_ : std::nan("");
+}
+
+template <typename T>
+double ErrorAccumulator<T>::maxRelError() const {
+    return (count_ > 0) ? maxRelError_ : std::nan("");
+}
+
+template <typename T>
+double ErrorAccumulator<T>::KLDivergence() const {
+    if (count_ == 0) {
+        return std::nan("");
+    }
+
+    // Both histograms hold count_ values
+    double kl = 0.0;
+    for (size_t bin = 0; bin < kNumBins; ++bin) {
+        if (originalHistogram_[bin] == 0) {
+            continue;
+        }
+        double p = static_cast<double>(originalHistogram_[bin]) / count_;
+        double q = static_cast<double>(decompressedHistogram_[bin]) / count_ + kSmoothing;
+        kl += p * std::log(p / q);
+    }
+    return std::max(kl, 0.0);
+}
+
+template <typename T>
+double ErrorAccumulator<T>::JSDivergence() const {
+    if (count_ == 0) {
+        return std::nan("");
+    }
+
+    double js = 0.0;
+    for (size_t bin = 0; bin < kNumBins; ++bin) {
+        double p = static_cast<double>(originalHistogram_[bin]) / count_;
+        double q = static_cast<double>(decompressedHistogram_[bin]) / count_;
+        double m = 0.5 * (p + q);
+        if (p > 0.0) {
+            js += 0.5 * p * std::log(p / m);
+        }
+        if (q > 0.0) {
+            js += 0.5 * q * std::log(q / m);
+        }
+    }
+    return std::max(js, 0.0);
+}
+
+template <typename T>
+double ErrorAccumulator<T>::WassersteinDistance() const {
+    if (count_ == 0) {
+        return std::nan("");
+    }
+
+    if (exactDistributions_) {
+        // With equal sample sizes, the integral of |F_P - F_Q| is the mean distance
+        // between the i-th smallest values of both samples
+        mergeRuns();
+        double distance = 0.0;
+        for (size_t i = 0; i < count_; ++i) {
+            double original = static_cast<double>(originalRuns_[i]);
+            double decompressed = static_cast<double>(decompressedRuns_[i]);
+            if (std::isfinite(original) && std::isfinite(decompressed)) {
+                distance += std::abs(original - decompressed);
+            }
+        }
+        return distance / count_;
+    }
+
+    // Integral of |F_P - F_Q| between consecutive bin midpoints; the infinite and NaN
+    // bins at either end have no finite width and are skipped
+    double distance = 0.0;
+    int64_t cdfDifference = 0;
+    double previousMidpoint = binMidpoint(0);
+    for (size_t bin = 0; bin < kNumBins; ++bin) {
+        double midpoint = binMidpoint(bin);
+        if (cdfDifference != 0 && std::isfinite(midpoint) && std::isfinite(previousMidpoint)) {
+            distance += std::abs(static_cast<double>(cdfDifference)) * (midpoint - previousMidpoint);
+        }
+        cdfDifference += static_cast<int64_t>(originalHistogram_[bin]) - static_cast<int64_t>(decompressedHistogram_[bin]);
+        previousMidpoint = midpoint;
+    }
+    return distance / count_;
+}
+
+template <typename T>
+double ErrorAccumulator<T>::KSStatistic() const {
+    if (count_ == 0) {
+        return std::nan("");
+    }
+
+    if (exactDistributions_) {
+        // Step both samples past each distinct value in turn; the CDFs are then i and j
+        mergeRuns();
+        size_t i = 0;
+        size_t j = 0;
+        size_t maxDifference = 0;
+        while (i < count_ || j < count_) {
+            T value = (j == count_ || (i < count_ && !sampleLess(decompressedRuns_[j], originalRuns_[i])))
+                ? originalRuns_[i] : decompressedRuns_[j];
+            while (i < count_ && !sampleLess(value, originalRuns_[i])) {
+                ++i;
+            }
+            while (j < count_ && !sampleLess(value, decompressedRuns_[j])) {
+                ++j;
+            }
+            maxDifference = std::max(maxDifference, (i > j) ? i - j : j - i);
+        }
+        return static_cast<double>(maxDifference) / count_;
+    }
+
+    int64_t cdfDifference = 0;
+    uint64_t maxDifference = 0;
+    for (size_t bin = 0; bin < kNumBins; ++bin) {
+        cdfDifference += static_cast<int64_t>(originalHistogram_[bin]) - static_cast<int64_t>(decompressedHistogram_[bin]);
+        maxDifference = std::max<uint64_t>(maxDifference, std::abs(cdfDifference));
+    }
+    return static_cast<double>(maxDifference) / count_;
+}
+
+template class ErrorAccumulator<float>;
+template class ErrorAccumulator<double>;
+template class ErrorAccumulator<int32_t>;
+template class ErrorAccumulator<char>;
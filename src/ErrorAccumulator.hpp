@@ -0,0 +1,140 @@
+/**
+ * @file ErrorAccumulator.hpp
+ * @brief Single-pass, mergeable accumulation of error metrics between original and decompressed data.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+/**
+ * @class ErrorAccumulator
+ * @brief Running error statistics, updated one chunk at a time.
+ *
+ * Every metric is gathered in one fused pass over each chunk, meant to run right after
+ * the chunk is decompressed while it is still in cache, so no full-size error arrays are
+ * needed. Accumulators of disjoint parts of the data can be merged, so worker threads
+ * keep their own and combine them at the end.
+ *
+ * Differences are taken in double, so integer columns cannot overflow.
+ *
+ * KL and JS divergence compare histograms of the original and decompressed values. Values
+ * are binned by the top kHistogramBits bits of their float bit pattern, mapped so that bins
+ * are in value order: bins need no prior knowledge of the range, cover every float at a
+ * fixed relative width (7 mantissa bits, i.e. under 1%), and two histograms of 2^16 counts
+ * each bound memory to 1 MiB regardless of the data size. The histograms are allocated on
+ * first update.
+ *
+ * Wasserstein distance and KS statistic are also derived from the histograms by default,
+ * which overstates the Wasserstein distance and understates KS for differences within a
+ * bin. Accumulators built with exactDistributions compute both exactly instead: each update
+ * keeps a sorted copy of the chunk's original and decompressed values as one run, merge
+ * appends the other's runs, and mergeRuns() merges all runs into one sorted sample per
+ * side. This costs two copies of the values, and a third while merging, so it is opt-in.
+ */
+template <typename T>
+class ErrorAccumulator {
+public:
+    /**
+     * @brief Construct an empty accumulator.
+     * @param exactDistributions Keep sorted runs of the values for the exact Wasserstein
+     *        distance and KS statistic, instead of bounding memory with histograms.
+     */
+    explicit ErrorAccumulator(bool exactDistributions = false) : exactDistributions_(exactDistributions) {}
+
+    /**
+     * @brief Add the errors of one chunk.
+     * @param original Original values.
+     * @param decompressed Decompressed values, as many as original.
+     * @return Maximum absolute error within this chunk (0 if it is empty).
+     * @throws std::invalid_argument if the sizes differ.
+     */
+    double update(std::span<const T> original, std::span<const T> decompressed);
+
+    /**
+     * @brief Add the errors accumulated by another accumulator.
+     * @throws std::invalid_argument if only one of them keeps exact distributions.
+     */
+    void merge(const ErrorAccumulator& other);
+
+    /** Number of values accumulated. */
+    size_t count() const { return count_; }
+
+    /** Whether WassersteinDistance() and KSStatistic() are exact rather than histogram-based. */
+    bool exactDistributions() const { return exactDistributions_; }
+
+    /**
+     * @brief Merge the sorted runs of exact distributions into one sorted sample per side.
+     *
+     * Each of the log2(runs) passes is split into numThreads equal slices of the output,
+     * merged concurrently. WassersteinDistance() and KSStatistic() call it on one thread if
+     * it was not called since the last update or merge. Not safe to call concurrently with
+     * any other method.
+     */
+    void mergeRuns(int numThreads = 1) const;
+
+    /** Mean squared error (NaN if empty). */
+    double MSE() const;
+
+    /** PSNR as 20log_10(MAX_I - 10log_10(MSE)), with MAX_I the value range (NaN if MSE is 0). */
+    double PSNR() const;
+
+    /** Mean absolute error (NaN if empty). */
+    double meanAbsError() const;
+
+    /** Maximum absolute error (NaN if empty). */
+    double maxAbsError() const;
+
+    /** Mean relative error in percent, counting zero originals as 0 (NaN if empty). */
+    double meanRelError() const;
+
+    /** Maximum relative error in percent (NaN if empty). */
+    double maxRelError() const;
+
+    /**
+     * KL divergence D(P||Q) of the decompressed histogram Q from the original P, in nats.
+     * Bin probabilities are smoothed by kSmoothing so empty bins of Q stay finite (NaN if empty).
+     */
+    double KLDivergence() const;
+
+    /** Jensen-Shannon divergence of the two histograms, in nats (at most ln 2; NaN if empty). */
+    double JSDivergence() const;
+
+    /**
+     * Wasserstein-1 (earth mover's) distance between the original and decompressed values,
+     * in units of the data: the mean absolute difference of the two sorted samples, over
+     * pairs where both are finite. Without exact distributions, the distance between the two
+     * histograms with each bin's mass at its midpoint (NaN if empty).
+     */
+    double WassersteinDistance() const;
+
+    /**
+     * Kolmogorov-Smirnov statistic: largest difference of the two empirical CDFs. Without
+     * exact distributions, taken at bin edges only (NaN if empty).
+     */
+    double KSStatistic() const;
+
+    static constexpr int kHistogramBits = 16;   ///< Bits of the ordered float pattern that select a bin
+    static constexpr double kSmoothing = 1e-10; ///< Probability added to every bin of Q in KLDivergence()
+
+private:
+    size_t count_{};
+    double sumSquaredError_{};
+    double sumAbsError_{};
+    double maxAbsError_{};
+    double sumRelError_{};
+    double maxRelError_{};
+    double minValue_{std::numeric_limits<double>::max()};
+    double maxValue_{std::numeric_limits<double>::lowest()};
+    std::vector<uint64_t> originalHistogram_;       ///< Counts per bin of original values
+    std::vector<uint64_t> decompressedHistogram_;   ///< Counts per bin of decompressed values
+
+    bool exactDistributions_;
+    // Sorted runs of both sides, ending at runEnds_; merged into one run on the first query
+    mutable std::vector<T> originalRuns_;
+    mutable std::vector<T> decompressedRuns_;
+    mutable std::vector<size_t> runEnds_;
+};
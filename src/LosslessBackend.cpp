@@ -0,0 +1,273 @@
+/**
+ * @file LosslessBackend.cpp
+ * @brief Implementation of the zlib, zstd, lz4 and libdeflate lossless backends.
+ */
+#include "LosslessBackend.hpp"
+
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <libdeflate.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zlib.h>
+#include <zstd.h>
+
+namespace {
+
+/**
+ * @brief Throw if level is outside [minLevel, maxLevel].
+ */
+void checkLevel(const std::string& name, int level, int minLevel, int maxLevel) {
+    if (level < minLevel || level > maxLevel) {
+        throw std::invalid_argument(std::format(
+            "{} compression level must be in [{},{}]", name, minLevel, maxLevel));
+    }
+}
+
+/**
+ * @brief Throw if a decompressed size differs from the expected one.
+ */
+void checkDecompressedSize(const std::string& name, size_t actual, size_t expected) {
+    if (actual != expected) {
+        throw std::runtime_error(std::format(
+            "{} decompressed {} bytes, expected {}", name, actual, expected));
+    }
+}
+
+class ZlibBackend : public LosslessBackend {
+public:
+    explicit ZlibBackend(int level) : level_(level) {
+        checkLevel(name(), level, Z_NO_COMPRESSION, Z_BEST_COMPRESSION);
+
+        // Same stream format as compress2/uncompress; the streams are set up once and reset per call
+        if (deflateInit(&deflate_, level) != Z_OK) {
+            throw std::runtime_error("zlib deflateInit failed");
+        }
+        if (inflateInit(&inflate_) != Z_OK) {
+            deflateEnd(&deflate_);
+            throw std::runtime_error("zlib inflateInit failed");
+        }
+    }
+
+    ~ZlibBackend() override {
+        deflateEnd(&deflate_);
+        inflateEnd(&inflate_);
+    }
+
+    // zlib streams point back at themselves, so they cannot be copied or moved
+    ZlibBackend(const ZlibBackend&) = delete;
+    ZlibBackend& operator=(const ZlibBackend&) = delete;
+
+    std::string name() const override { return "zlib"; }
+    int level() const override { return level_; }
+
+    size_t compressBound(size_t numBytes) const override {
+        return ::compressBound(numBytes);
+    }
+
+    size_t compress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        checkStreamSize(input.size());
+        if (deflateReset(&deflate_) != Z_OK) {
+            throw std::runtime_error("zlib deflateReset failed");
+        }
+        deflate_.next_in = const_cast<Bytef*>(input.data());
+        deflate_.avail_in = static_cast<uInt>(input.size());
+        deflate_.next_out = output.data();
+        deflate_.avail_out = static_cast<uInt>(std::min<size_t>(output.size(), std::numeric_limits<uInt>::max()));
+
+        if (deflate(&deflate_, Z_FINISH) != Z_STREAM_END) {
+            throw std::runtime_error("zlib deflate failed");
+        }
+        return deflate_.total_out;
+    }
+
+    void decompress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        checkStreamSize(output.size());
+        if (inflateReset(&inflate_) != Z_OK) {
+            throw std::runtime_error("zlib inflateReset failed");
+        }
+        inflate_.next_in = const_cast<Bytef*>(input.data());
+        inflate_.avail_in = static_cast<uInt>(std::min<size_t>(input.size(), std::numeric_limits<uInt>::max()));
+        inflate_.next_out = output.data();
+        inflate_.avail_out = static_cast<uInt>(output.size());
+
+        if (inflate(&inflate_, Z_FINISH) != Z_STREAM_END) {
+            throw std::runtime_error("zlib inflate failed");
+        }
+        checkDecompressedSize(name(), inflate_.total_out, output.size());
+    }
+
+private:
+    int level_;
+    z_stream deflate_{};    ///< Compression stream, reset for every chunk
+    z_stream inflate_{};    ///< Decompression stream, reset for every chunk
+
+    /** zlib sizes are uInts, so one call handles at most 4 GiB. */
+    static void checkStreamSize(size_t numBytes) {
+        if (numBytes > std::numeric_limits<uInt>::max()) {
+            throw std::invalid_argument("zlib chunks must be smaller than 4 GiB");
+        }
+    }
+};
+
+class ZstdBackend : public LosslessBackend {
+public:
+    explicit ZstdBackend(int level)
+        : level_(level), cctx_(ZSTD_createCCtx(), ZSTD_freeCCtx), dctx_(ZSTD_createDCtx(), ZSTD_freeDCtx)
+    {
+        checkLevel(name(), level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+        if (!cctx_ || !dctx_) {
+            throw std::runtime_error("Failed to create zstd contexts");
+        }
+    }
+
+    std::string name() const override { return "zstd"; }
+    int level() const override { return level_; }
+
+    size_t compressBound(size_t numBytes) const override {
+        return ZSTD_compressBound(numBytes);
+    }
+
+    size_t compress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        // Contexts are reused across calls, so only the first call allocates codec state
+        size_t res = ZSTD_compressCCtx(cctx_.get(), output.data(), output.size(), input.data(), input.size(), level_);
+        if (ZSTD_isError(res)) {
+            throw std::runtime_error(std::format("zstd compression failed: {}", ZSTD_getErrorName(res)));
+        }
+        return res;
+    }
+
+    void decompress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        size_t res = ZSTD_decompressDCtx(dctx_.get(), output.data(), output.size(), input.data(), input.size());
+        if (ZSTD_isError(res)) {
+            throw std::runtime_error(std::format("zstd decompression failed: {}", ZSTD_getErrorName(res)));
+        }
+        checkDecompressedSize(name(), res, output.size());
+    }
+
+private:
+    int level_;
+    std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx_;
+    std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx_;
+};
+
+class LZ4Backend : public LosslessBackend {
+public:
+    explicit LZ4Backend(int level) : level_(level) {
+        checkLevel(name(), level, 0, LZ4HC_CLEVEL_MAX);
+
+        // Compression state is allocated once and reinitialized in place by every call
+        size_t stateSize = (level_ == 0) ? LZ4_sizeofState() : LZ4_sizeofStateHC();
+        state_.resize((stateSize + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    }
+
+    std::string name() const override { return "lz4"; }
+    int level() const override { return level_; }
+
+    size_t compressBound(size_t numBytes) const override {
+        checkInputSize(numBytes);
+        return LZ4_compressBound(static_cast<int>(numBytes));
+    }
+
+    size_t compress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        checkInputSize(input.size());
+        const char* src = reinterpret_cast<const char*>(input.data());
+        char* dst = reinterpret_cast<char*>(output.data());
+        int srcSize = static_cast<int>(input.size());
+        int dstCapacity = static_cast<int>(std::min<size_t>(output.size(), std::numeric_limits<int>::max()));
+
+        // Level 0 is the fast LZ4 codec, higher levels are LZ4HC
+        int res = (level_ == 0) ? LZ4_compress_fast_extState(state_.data(), src, dst, srcSize, dstCapacity, 1)
+                                : LZ4_compress_HC_extStateHC(state_.data(), src, dst, srcSize, dstCapacity, level_);
+        if (res <= 0 && srcSize > 0) {
+            throw std::runtime_error("lz4 compression failed");
+        }
+        return res;
+    }
+
+    void decompress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        checkInputSize(output.size());
+        int res = LZ4_decompress_safe(reinterpret_cast<const char*>(input.data()), reinterpret_cast<char*>(output.data()),
+                                      static_cast<int>(input.size()), static_cast<int>(output.size()));
+        if (res < 0) {
+            throw std::runtime_error("lz4 decompression failed");
+        }
+        checkDecompressedSize(name(), res, output.size());
+    }
+
+private:
+    int level_;
+    std::vector<uint64_t> state_;   ///< LZ4 or LZ4HC compression state (8-byte aligned)
+
+    /** LZ4 sizes are ints, so chunks are limited to LZ4_MAX_INPUT_SIZE bytes. */
+    static void checkInputSize(size_t numBytes) {
+        if (numBytes > LZ4_MAX_INPUT_SIZE) {
+            throw std::invalid_argument(std::format("lz4 chunks must be at most {} bytes", LZ4_MAX_INPUT_SIZE));
+        }
+    }
+};
+
+class LibdeflateBackend : public LosslessBackend {
+public:
+    explicit LibdeflateBackend(int level)
+        : level_(level), compressor_(nullptr, libdeflate_free_compressor),
+          decompressor_(libdeflate_alloc_decompressor(), libdeflate_free_decompressor)
+    {
+        checkLevel(name(), level, 0, 12);
+        compressor_.reset(libdeflate_alloc_compressor(level));
+        if (!compressor_ || !decompressor_) {
+            throw std::runtime_error("Failed to create libdeflate contexts");
+        }
+    }
+
+    std::string name() const override { return "libdeflate"; }
+    int level() const override { return level_; }
+
+    size_t compressBound(size_t numBytes) const override {
+        return libdeflate_zlib_compress_bound(compressor_.get(), numBytes);
+    }
+
+    size_t compress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        // zlib framing, so streams are interchangeable with the zlib backend
+        size_t res = libdeflate_zlib_compress(compressor_.get(), input.data(), input.size(), output.data(), output.size());
+        if (res == 0 && !input.empty()) {
+            throw std::runtime_error("libdeflate compression failed");
+        }
+        return res;
+    }
+
+    void decompress(std::span<const uint8_t> input, std::span<uint8_t> output) override {
+        size_t actual = 0;
+        libdeflate_result res = libdeflate_zlib_decompress(decompressor_.get(), input.data(), input.size(),
+                                                           output.data(), output.size(), &actual);
+        if (res != LIBDEFLATE_SUCCESS) {
+            throw std::runtime_error("libdeflate decompression failed");
+        }
+        checkDecompressedSize(name(), actual, output.size());
+    }
+
+private:
+    int level_;
+    std::unique_ptr<libdeflate_compressor, void (*)(libdeflate_compressor*)> compressor_;
+    std::unique_ptr<libdeflate_decompressor, void (*)(libdeflate_decompressor*)> decompressor_;
+};
+
+} // namespace
+
+std::unique_ptr<LosslessBackend> makeLosslessBackend(const std::string& name, int level) {
+    if (name == "zlib") {
+        return std::make_unique<ZlibBackend>(level);
+    } else if (name == "zstd") {
+        return std::make_unique<ZstdBackend>(level);
+    } else if (name == "lz4") {
+        return std::make_unique<LZ4Backend>(level);
+    } else if (name == "libdeflate") {
+        return std::make_unique<LibdeflateBackend>(level);
+    } else {
+        throw std::invalid_argument("Unknown lossless backend: " + name);
+    }
+}
@@ -0,0 +1,64 @@
+/**
+ * @file LosslessBackend.hpp
+ * @brief Lossless byte codecs (zlib, zstd, lz4, libdeflate) used as the last stage of lossy compressors.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+/**
+ * @class LosslessBackend
+ * @brief Lossless codec for byte buffers, at a fixed compression level.
+ *
+ * Each instance keeps its codec contexts and state between calls (reset rather than
+ * rebuilt per chunk), so the per-chunk cost is the compression work alone. An instance
+ * must therefore not be used by more than one thread at a time.
+ */
+class LosslessBackend {
+public:
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~LosslessBackend() = default;
+
+    /** Codec name, as accepted by makeLosslessBackend(). */
+    virtual std::string name() const = 0;
+
+    /** Compression level the codec was created with. */
+    virtual int level() const = 0;
+
+    /**
+     * @brief Upper bound on the compressed size of numBytes input bytes.
+     */
+    virtual size_t compressBound(size_t numBytes) const = 0;
+
+    /**
+     * @brief Compress input into output.
+     * @param input Bytes to compress.
+     * @param output Buffer of at least compressBound(input.size()) bytes.
+     * @return Number of compressed bytes written to output.
+     * @throws std::runtime_error if the codec fails.
+     */
+    virtual size_t compress(std::span<const uint8_t> input, std::span<uint8_t> output) = 0;
+
+    /**
+     * @brief Decompress input into output.
+     * @param input Compressed bytes.
+     * @param output Buffer of exactly the original number of bytes.
+     * @throws std::runtime_error if the codec fails or the size does not match output.
+     */
+    virtual void decompress(std::span<const uint8_t> input, std::span<uint8_t> output) = 0;
+};
+
+/**
+ * @brief Create a lossless backend from its name and compression level.
+ * @param name Codec name: "zlib" (levels 0-9), "zstd" (ZSTD_minCLevel() to ZSTD_maxCLevel()),
+ *             "lz4" (0 = fast LZ4, 1-12 = LZ4HC) or "libdeflate" (0-12).
+ * @param level Compression level.
+ * @return Owning pointer to the new backend.
+ * @throws std::invalid_argument if the codec is unknown or the level is out of range.
+ */
+std::unique_ptr<LosslessBackend> makeLosslessBackend(const std::string& name, int level);
@@ -0,0 +1,180 @@
+/**
+ * @file PerfCounters.cpp
+ * @brief perf_event_open-based implementation of PerfCounterGroup.
+ */
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "PerfCounters.hpp"
+#include "../utils/utils.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+/**
+ * @brief perf_event_open config of each PerfEvent.
+ */
+constexpr std::array<uint64_t, kNumPerfEvents> kEventConfigs{
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+/**
+ * @brief Open one hardware event for the calling thread on any CPU, in user space only.
+ * @param groupFd Group leader, or -1 to open a new group.
+ * @return File descriptor, or -1 with errno set.
+ */
+int openEvent(uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (groupFd == -1) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+#endif
+
+/**
+ * @brief Report once per process that counters are unavailable, and why.
+ */
+void warnUnavailable(const std::string& reason) {
+    static std::once_flag warned;
+    std::call_once(warned, [&reason]() {
+        std::cerr << timeMessage("Warning: hardware performance counters unavailable (" + reason +
+                                 "); perf results will be omitted") << std::endl;
+    });
+}
+
+} // namespace
+
+std::string perfEventName(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::CacheMisses: return "cacheMisses";
+        case PerfEvent::BranchMisses: return "branchMisses";
+        default: return "unknown";
+    }
+}
+
+bool PerfCounts::any() const {
+    for (bool v : valid) {
+        if (v) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other) {
+    bool empty = !any();
+    for (size_t i = 0; i < kNumPerfEvents; ++i) {
+        values[i] += other.values[i];
+        valid[i] = empty ? other.valid[i] : (valid[i] && other.valid[i]);
+    }
+    numBytes += other.numBytes;
+    return *this;
+}
+
+double PerfCounts::cyclesPerByte() const {
+    return (has(PerfEvent::Cycles) && numBytes > 0)
+        ? static_cast<double>((*this)[PerfEvent::Cycles]) / numBytes : std::nan("");
+}
+
+double PerfCounts::IPC() const {
+    return (has(PerfEvent::Cycles) && has(PerfEvent::Instructions) && (*this)[PerfEvent::Cycles] > 0)
+        ? static_cast<double>((*this)[PerfEvent::Instructions]) / (*this)[PerfEvent::Cycles] : std::nan("");
+}
+
+PerfCounterGroup::PerfCounterGroup() {
+    fds_.fill(-1);
+    readIndex_.fill(-1);
+
+#ifdef __linux__
+    // The cycle counter leads the group; without it there is nothing useful to report
+    for (size_t i = 0; i < kNumPerfEvents; ++i) {
+        int fd = openEvent(kEventConfigs[i], leader_);
+        if (fd < 0) {
+            if (i == 0) {
+                warnUnavailable(std::strerror(errno));
+                return;
+            }
+            continue;
+        }
+        if (i == 0) {
+            leader_ = fd;
+        }
+        fds_[i] = fd;
+        readIndex_[i] = numOpened_++;
+    }
+
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    warnUnavailable("perf_event_open is Linux-only");
+#endif
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+#ifdef __linux__
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+PerfCounts PerfCounterGroup::sample() const {
+    PerfCounts counts;
+    if (!available()) {
+        return counts;
+    }
+
+#ifdef __linux__
+    // Group read layout: nr, time_enabled, time_running, then one value per event
+    std::array<uint64_t, 3 + kNumPerfEvents> buffer{};
+    if (read(leader_, buffer.data(), sizeof(buffer)) < static_cast<ssize_t>((3 + numOpened_) * sizeof(uint64_t))) {
+        return counts;
+    }
+
+    // Scale up if the kernel had to multiplex the group with other events
+    uint64_t enabled = buffer[1];
+    uint64_t running = buffer[2];
+    double scale = (running > 0 && running < enabled) ? static_cast<double>(enabled) / running : 1.0;
+    for (size_t i = 0; i < kNumPerfEvents; ++i) {
+        if (readIndex_[i] >= 0) {
+            counts.values[i] = static_cast<uint64_t>(buffer[3 + readIndex_[i]] * scale);
+            counts.valid[i] = true;
+        }
+    }
+#endif
+    return counts;
+}
+
+PerfCounts PerfCounterGroup::delta(const PerfCounts& start, const PerfCounts& end, size_t numBytes) {
+    PerfCounts counts;
+    for (size_t i = 0; i < kNumPerfEvents; ++i) {
+        counts.valid[i] = start.valid[i] && end.valid[i];
+        counts.values[i] = (counts.valid[i] && end.values[i] > start.values[i]) ? end.values[i] - start.values[i] : 0;
+    }
+    counts.numBytes = numBytes;
+    return counts;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file PerfCounters.hpp
+ * @brief Per-thread hardware performance counters (Linux perf_event_open) around compression calls.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Hardware events counted by PerfCounterGroup.
+ */
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    CacheMisses,    ///< Last-level cache misses
+    BranchMisses,
+    Count           ///< Number of events
+};
+
+constexpr size_t kNumPerfEvents = static_cast<size_t>(PerfEvent::Count);
+
+/**
+ * @brief Name of an event, as used in the results JSON ("cycles", "instructions", ...).
+ */
+std::string perfEventName(PerfEvent event);
+
+/**
+ * @brief Event counts accumulated over a number of calls.
+ *
+ * Events the host cannot count (no PMU, restricted perf_event_paranoid, unsupported
+ * event in a VM) are marked invalid rather than reported as zero.
+ */
+struct PerfCounts {
+    std::array<uint64_t, kNumPerfEvents> values{};
+    std::array<bool, kNumPerfEvents> valid{};
+    size_t numBytes{};      // Input bytes processed while counting
+
+    uint64_t operator[](PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+    bool has(PerfEvent event) const { return valid[static_cast<size_t>(event)]; }
+
+    /** True if any event was counted. */
+    bool any() const;
+
+    /** Add another set of counts; an event stays valid only if valid in both (or this is empty). */
+    PerfCounts& operator+=(const PerfCounts& other);
+
+    /** Cycles per input byte (NaN if unavailable). */
+    double cyclesPerByte() const;
+
+    /** Instructions per cycle (NaN if unavailable). */
+    double IPC() const;
+};
+
+/**
+ * @class PerfCounterGroup
+ * @brief Hardware counters of the calling thread, read before and after a region of code.
+ *
+ * The events are opened as one perf_event group on construction, counting user space
+ * only (so perf_event_paranoid up to 2 is enough), and stay enabled; sample() reads the
+ * whole group with one read() call. Construction never fails: if the counters cannot be
+ * opened, available() is false and sample() returns empty counts. The group counts the
+ * thread that constructed it, so each worker thread needs its own.
+ */
+class PerfCounterGroup {
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    /** True if at least the cycle counter could be opened. */
+    bool available() const { return leader_ >= 0; }
+
+    /**
+     * @brief Current counter values, scaled for multiplexing.
+     *
+     * Subtract two samples (see delta()) to count a region.
+     */
+    PerfCounts sample() const;
+
+    /**
+     * @brief Counts between two samples, attributed to numBytes input bytes.
+     */
+    static PerfCounts delta(const PerfCounts& start, const PerfCounts& end, size_t numBytes);
+
+private:
+    int leader_{-1};                                ///< Group leader fd (cycles), -1 if unavailable
+    std::array<int, kNumPerfEvents> fds_{};         ///< fd of each event, -1 if it could not be opened
+    std::array<int, kNumPerfEvents> readIndex_{};   ///< Position of each event in a group read, -1 if not opened
+    int numOpened_{};                               ///< Events in the group
+};
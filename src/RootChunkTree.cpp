@@ -0,0 +1,178 @@
+/**
+ * @file RootChunkTree.cpp
+ * @brief Writing compressed chunks to a ROOT tree and reading them back through the compressor.
+ */
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <TFile.h>
+#include <TNamed.h>
+#include <TTree.h>
+#include <TTreeReader.h>
+#include <TTreeReaderValue.h>
+
+#include "CompressorBenchmark.hpp"
+#include "RootChunkTree.hpp"
+#include "../utils/cli.hpp"
+#include "../utils/utils.hpp"
+
+namespace {
+
+/**
+ * @brief Format options as "key=value;key=value".
+ */
+std::string formatOptions(const std::map<std::string, std::string>& options) {
+    std::string text;
+    for (const auto& [key, value] : options) {
+        text += (text.empty() ? "" : ";") + key + "=" + value;
+    }
+    return text;
+}
+
+/**
+ * @brief Parse options formatted by formatOptions().
+ */
+std::map<std::string, std::string> parseOptions(const std::string& text) {
+    std::map<std::string, std::string> options;
+    for (const std::string& option : tokenize(text, ';')) {
+        size_t equals = option.find('=');
+        if (equals == std::string::npos) {
+            throw std::runtime_error("Malformed compressor option: " + option);
+        }
+        options[option.substr(0, equals)] = option.substr(equals + 1);
+    }
+    return options;
+}
+
+} // namespace
+
+template <typename T>
+void writeChunkTree(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname,
+    const JaggedColumnView<T>& column,
+    std::span<const size_t> boundaries,
+    const std::string& compressorName,
+    const std::map<std::string, std::string>& compressorOptions
+)
+{
+    std::shared_ptr<Compressor<T>> compressor = makeCompressor<T>(compressorName, compressorOptions);
+
+    // Chunks are already compressed, so ROOT stores them as is
+    std::unique_ptr<TFile> file(TFile::Open(filename.c_str(), "RECREATE", "", 0));
+    if (!file || file->IsZombie()) {
+        throw std::runtime_error("Failed to create file '" + filename + "'");
+    }
+
+    // The file owns the tree and deletes it on Close()
+    TTree* tree = new TTree(treename.c_str(), "ROOTLess compressed chunks");
+    tree->SetDirectory(file.get());
+    tree->SetAutoFlush(-64 * 1024 * 1024);
+
+    std::vector<unsigned char> chunkBytes;
+    std::vector<unsigned char>* chunkAddress = &chunkBytes;
+    ULong64_t numValues = 0;
+    std::vector<ULong64_t> entryOffsets;
+    std::vector<ULong64_t>* entryOffsetsAddress = &entryOffsets;
+    tree->Branch((branchname + "_chunk").c_str(), &chunkAddress, 256 * 1024);
+    tree->Branch((branchname + "_numValues").c_str(), &numValues);
+    tree->Branch((branchname + "_entryOffsets").c_str(), &entryOffsetsAddress);
+
+    // Entries [firstEntry, endEntry) start in the current chunk; empty entries at a chunk
+    // boundary go with the next chunk, trailing empty entries with the last one
+    size_t numChunks = boundaries.size() - 1;
+    size_t numEntries = column.numEntries();
+    size_t firstEntry = 0;
+    CompressedData compressed;
+    for (size_t chunkInx = 0; chunkInx < numChunks; ++chunkInx) {
+        std::span<const T> chunk = column.values.subspan(boundaries[chunkInx], boundaries[chunkInx + 1] - boundaries[chunkInx]);
+        compressor->compress(chunk, compressed);
+        chunkBytes.assign(compressed.data.begin(), compressed.data.begin() + compressed.numBytes);
+        numValues = chunk.size();
+
+        size_t endEntry = (chunkInx + 1 == numChunks)
+            ? numEntries
+            : std::lower_bound(column.offsets.begin() + firstEntry, column.offsets.begin() + numEntries, boundaries[chunkInx + 1]) - column.offsets.begin();
+        entryOffsets.assign(column.offsets.begin() + firstEntry, column.offsets.begin() + endEntry);
+        firstEntry = endEntry;
+
+        if (tree->Fill() < 0) {
+            throw std::runtime_error(std::format("Failed to fill chunk {} of tree '{}'", chunkInx, treename));
+        }
+    }
+
+    TNamed compressorNamed((branchname + "_compressor").c_str(), compressorName.c_str());
+    TNamed optionsNamed((branchname + "_options").c_str(), formatOptions(compressor->getConfig()).c_str());
+    if (tree->Write() <= 0 || file->WriteTObject(&compressorNamed) <= 0 || file->WriteTObject(&optionsNamed) <= 0) {
+        throw std::runtime_error("Failed to write chunk tree to file '" + filename + "'");
+    }
+    file->Close();
+
+    std::cout << timeMessage(std::format("Wrote {} compressed chunks of branch '{}' to file '{}'",
+                                         numChunks, branchname, filename)) << std::endl;
+}
+
+template <typename T>
+JaggedColumn<T> readChunkTree(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname
+)
+{
+    std::unique_ptr<TFile> file(TFile::Open(filename.c_str(), "READ"));
+    if (!file || file->IsZombie()) {
+        throw std::runtime_error("Failed to open file '" + filename + "'");
+    }
+
+    TNamed* compressorNamed = file->Get<TNamed>((branchname + "_compressor").c_str());
+    TNamed* optionsNamed = file->Get<TNamed>((branchname + "_options").c_str());
+    if (!compressorNamed || !optionsNamed) {
+        throw std::runtime_error("No compressor settings for branch '" + branchname + "' in file '" + filename + "'");
+    }
+    std::shared_ptr<Compressor<T>> decompressor = makeCompressor<T>(compressorNamed->GetTitle(), parseOptions(optionsNamed->GetTitle()));
+
+    if (!file->Get<TTree>(treename.c_str())) {
+        throw std::runtime_error("Tree '" + treename + "' not found in file '" + filename + "'");
+    }
+    TTreeReader reader(treename.c_str(), file.get());
+    TTreeReaderValue<std::vector<unsigned char>> chunkBytes(reader, (branchname + "_chunk").c_str());
+    TTreeReaderValue<ULong64_t> numValues(reader, (branchname + "_numValues").c_str());
+    TTreeReaderValue<std::vector<ULong64_t>> entryOffsets(reader, (branchname + "_entryOffsets").c_str());
+
+    JaggedColumn<T> column;
+    column.offsets.clear();
+    CompressedData compressed;
+    while (reader.Next()) {
+        compressed.data.assign(chunkBytes->begin(), chunkBytes->end());
+        compressed.numBytes = chunkBytes->size();
+        compressed.numElements = *numValues;
+
+        size_t first = column.values.size();
+        column.values.resize(first + *numValues);
+        decompressor->decompress(compressed, std::span<T>(column.values).subspan(first, *numValues));
+        column.offsets.insert(column.offsets.end(), entryOffsets->begin(), entryOffsets->end());
+    }
+    column.offsets.push_back(column.values.size());
+
+    file->Close();
+    return column;
+}
+
+template void writeChunkTree<float>(const std::string&, const std::string&, const std::string&, const JaggedColumnView<float>&,
+                                    std::span<const size_t>, const std::string&, const std::map<std::string, std::string>&);
+template void writeChunkTree<double>(const std::string&, const std::string&, const std::string&, const JaggedColumnView<double>&,
+                                     std::span<const size_t>, const std::string&, const std::map<std::string, std::string>&);
+template void writeChunkTree<int32_t>(const std::string&, const std::string&, const std::string&, const JaggedColumnView<int32_t>&,
+                                      std::span<const size_t>, const std::string&, const std::map<std::string, std::string>&);
+template void writeChunkTree<char>(const std::string&, const std::string&, const std::string&, const JaggedColumnView<char>&,
+                                   std::span<const size_t>, const std::string&, const std::map<std::string, std::string>&);
+
+template JaggedColumn<float> readChunkTree<float>(const std::string&, const std::string&, const std::string&);
+template JaggedColumn<double> readChunkTree<double>(const std::string&, const std::string&, const std::string&);
+template JaggedColumn<int32_t> readChunkTree<int32_t>(const std::string&, const std::string&, const std::string&);
+template JaggedColumn<char> readChunkTree<char>(const std::string&, const std::string&, const std::string&);
@@ -0,0 +1,61 @@
+/**
+ * @file RootChunkTree.hpp
+ * @brief Compressed chunks stored as opaque entries of a ROOT tree, for end-to-end read benchmarks.
+ */
+#pragma once
+
+#include <map>
+#include <span>
+#include <string>
+
+#include "../utils/column.hpp"
+
+/**
+ * @brief Write a column as a tree of compressed chunks that ROOT can read back.
+ *
+ * The tree has one entry per chunk, with three branches:
+ *   - <branch>_chunk         std::vector<unsigned char>, the compressed bytes
+ *   - <branch>_numValues     ULong64_t, the number of values in the chunk
+ *   - <branch>_entryOffsets  std::vector<ULong64_t>, value offsets of the entries starting in the chunk
+ *
+ * The compressor name and its Compressor::getConfig() options are stored next to the tree
+ * as TNamed objects <branch>_compressor and <branch>_options ("key=value;..."), so the file
+ * can be decompressed without other input. The file itself is not compressed by ROOT, as
+ * the chunks already are.
+ *
+ * @param filename Path to the ROOT file, which is overwritten.
+ * @param treename Name of the tree to create.
+ * @param branchname Name of the branch the column was read from.
+ * @param column Column to compress.
+ * @param boundaries Value offsets where chunks start, followed by the number of values.
+ * @param compressorName Name of the compressor (see makeCompressor()).
+ * @param compressorOptions Options of the compressor.
+ * @throws std::runtime_error if the file cannot be created or written.
+ */
+template <typename T>
+void writeChunkTree(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname,
+    const JaggedColumnView<T>& column,
+    std::span<const size_t> boundaries,
+    const std::string& compressorName,
+    const std::map<std::string, std::string>& compressorOptions
+);
+
+/**
+ * @brief Read a column written by writeChunkTree(): open the file, read every chunk and
+ *        decompress it into one column.
+ *
+ * @param filename Path to the ROOT file.
+ * @param treename Name of the tree in the file.
+ * @param branchname Name the column was written under.
+ * @return The decompressed values and their entry offsets.
+ * @throws std::runtime_error if the file, tree or compressor settings cannot be read.
+ */
+template <typename T>
+JaggedColumn<T> readChunkTree(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname
+);
@@ -0,0 +1,188 @@
+/**
+ * @file RootCompressor.cpp
+ * @brief Implementation of RootCompressor, compressing chunks with ROOT's R__zip API.
+ */
+#include "RootCompressor.hpp"
+#include "../utils/root.hpp"
+#include <RZip.h>
+#include <Compression.h>
+#include <format>
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+constexpr size_t kMaxZipBuffer = 0xffffff;     ///< Largest block R__zip compresses at once (ROOT's kMAXZIPBUF)
+constexpr size_t kZipHeaderSize = 9;            ///< Header ROOT writes before every compressed block
+
+/** First byte of every chunk: how the rest of it is stored. */
+enum ChunkMode : uint8_t {
+    Stored = 0,         ///< Raw bytes, because some block did not shrink
+    Zipped = 1,         ///< One ROOT-compressed block per kMaxZipBuffer input bytes
+};
+
+} // namespace
+
+template <typename T>
+RootCompressor<T>::RootCompressor(const std::string& algorithm, int compressionLevel) {
+    resetSettings(algorithm, compressionLevel);
+}
+
+template <typename T>
+RootCompressor<T>::RootCompressor(const std::map<std::string, std::string>& config) {
+    auto it = config.find("algorithm");
+    if (it == config.end()) {
+        throw std::invalid_argument("algorithm is required in RootCompressor config");
+    }
+    std::string algorithm = it->second;
+
+    it = config.find("compressionLevel");
+    if (it == config.end()) {
+        throw std::invalid_argument("compressionLevel is required in RootCompressor config");
+    }
+    resetSettings(algorithm, std::stoi(it->second));
+}
+
+template <typename T>
+void RootCompressor<T>::setAlgorithm(const std::string& algorithm) {
+    resetSettings(algorithm, compressionLevel_);
+}
+
+template <typename T>
+std::string RootCompressor<T>::getAlgorithm() const {
+    return algorithm_;
+}
+
+template <typename T>
+void RootCompressor<T>::setCompressionLevel(int level) {
+    resetSettings(algorithm_, level);
+}
+
+template <typename T>
+int RootCompressor<T>::getCompressionLevel() const {
+    return compressionLevel_;
+}
+
+template <typename T>
+void RootCompressor<T>::resetSettings(const std::string& algorithm, int compressionLevel) {
+    // Level 0 makes ROOT store baskets uncompressed, which is not a codec to benchmark
+    if (compressionLevel < 1 || compressionLevel > 9) {
+        throw std::invalid_argument("RootCompressor compressionLevel must be in [1,9]");
+    }
+    settings_ = rootCompressionSettings(algorithm, compressionLevel);
+    algorithm_ = algorithm;
+    compressionLevel_ = compressionLevel;
+}
+
+template <typename T>
+std::string RootCompressor<T>::toString() const {
+    return std::format("RootCompressor({},{})", algorithm_, compressionLevel_);
+}
+
+template <typename T>
+std::map<std::string, std::string> RootCompressor<T>::getConfig() const {
+    return {
+        {"algorithm", algorithm_},
+        {"compressionLevel", std::to_string(compressionLevel_)}
+    };
+}
+
+template <typename T>
+size_t RootCompressor<T>::compressBound(size_t numElements) const {
+    // Blocks that do not fit in their input size make the whole chunk stored
+    return 1 + numElements * sizeof(T);
+}
+
+template <typename T>
+void RootCompressor<T>::compress(std::span<const T> data, CompressedData& compressed) {
+    size_t numBytes = data.size() * sizeof(T);
+    if (compressed.data.size() < compressBound(data.size())) {
+        compressed.data.resize(compressBound(data.size()));
+    }
+    compressed.numElements = data.size();
+
+    // R__zip takes non-const buffers but does not write to the source
+    char* input = const_cast<char*>(reinterpret_cast<const char*>(data.data()));
+    char* output = reinterpret_cast<char*>(compressed.data.data()) + 1;
+    auto algorithm = static_cast<ROOT::RCompressionSetting::EAlgorithm::EValues>(settings_ / 100);
+
+    // Same blocking and fallback as TBasket::WriteBuffer
+    bool zipped = numBytes > 0;
+    size_t position = 0;
+    size_t outputBytes = 0;
+    while (zipped && position < numBytes) {
+        size_t blockBytes = std::min(kMaxZipBuffer, numBytes - position);
+        int sourceBytes = static_cast<int>(blockBytes);
+        int targetBytes = static_cast<int>(blockBytes);
+        int blockOutputBytes = 0;
+        R__zipMultipleAlgorithm(compressionLevel_, &sourceBytes, input + position, &targetBytes,
+                                output + outputBytes, &blockOutputBytes, algorithm);
+        zipped = blockOutputBytes > 0 && static_cast<size_t>(blockOutputBytes) < blockBytes;
+        position += blockBytes;
+        outputBytes += blockOutputBytes;
+    }
+
+    if (zipped) {
+        compressed.data[0] = ChunkMode::Zipped;
+        compressed.numBytes = 1 + outputBytes;
+    } else {
+        compressed.data[0] = ChunkMode::Stored;
+        std::memcpy(output, input, numBytes);
+        compressed.numBytes = 1 + numBytes;
+    }
+}
+
+template <typename T>
+void RootCompressor<T>::decompress(const CompressedData& compressedData, std::span<T> output) {
+    if (output.size() < compressedData.numElements) {
+        throw std::invalid_argument("Output buffer too small for decompressed data");
+    }
+    if (compressedData.numBytes < 1) {
+        throw std::runtime_error("RootCompressor chunk is empty");
+    }
+
+    size_t numBytes = compressedData.numElements * sizeof(T);
+    const unsigned char* input = compressedData.data.data() + 1;
+    size_t inputBytes = compressedData.numBytes - 1;
+    unsigned char* values = reinterpret_cast<unsigned char*>(output.data());
+
+    if (compressedData.data[0] == ChunkMode::Stored) {
+        if (inputBytes != numBytes) {
+            throw std::runtime_error("RootCompressor stored chunk has the wrong size");
+        }
+        std::memcpy(values, input, numBytes);
+        return;
+    }
+
+    // Every block starts with ROOT's header giving its compressed and uncompressed size
+    size_t position = 0;
+    size_t outputBytes = 0;
+    while (position < inputBytes) {
+        int blockBytes = 0;
+        int targetBytes = 0;
+        unsigned char* block = const_cast<unsigned char*>(input + position);
+        if (inputBytes - position < kZipHeaderSize || R__unzip_header(&blockBytes, block, &targetBytes) != 0 ||
+            static_cast<size_t>(blockBytes) > inputBytes - position ||
+            static_cast<size_t>(targetBytes) > numBytes - outputBytes)
+        {
+            throw std::runtime_error("RootCompressor chunk has a corrupt block header");
+        }
+
+        int blockOutputBytes = 0;
+        R__unzip(&blockBytes, block, &targetBytes, values + outputBytes, &blockOutputBytes);
+        if (blockOutputBytes != targetBytes) {
+            throw std::runtime_error(std::format("R__unzip failed: {} of {} bytes decompressed", blockOutputBytes, targetBytes));
+        }
+        position += blockBytes;
+        outputBytes += blockOutputBytes;
+    }
+    if (outputBytes != numBytes) {
+        throw std::runtime_error(std::format("RootCompressor chunk decompressed to {} bytes, expected {}", outputBytes, numBytes));
+    }
+}
+
+template class RootCompressor<float>;
+template class RootCompressor<double>;
+template class RootCompressor<int32_t>;
+template class RootCompressor<char>;
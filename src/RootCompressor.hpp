@@ -0,0 +1,81 @@
+/**
+ * @file RootCompressor.hpp
+ * @brief RootCompressor class for lossless compression with ROOT's built-in algorithms, as a baseline.
+ */
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <map>
+#include "Compressor.hpp"
+
+/**
+ * @class RootCompressor
+ * @brief Compressor that runs ROOT's R__zip over the flat native-endian values of a chunk.
+ *
+ * Each chunk is split into blocks of at most 16 MiB - 1 bytes (ROOT's kMAXZIPBUF) and every
+ * block is passed to R__zipMultipleAlgorithm with the chosen algorithm and level, each block
+ * carrying ROOT's own 9-byte header. As in TBasket, a chunk with any block that does not
+ * shrink is stored uncompressed instead.
+ *
+ * This is not the byte stream ROOT compresses: baskets hold big-endian serialized
+ * std::vector entries with per-entry byte counts and an offset array, and byte order and
+ * layout change what the algorithms find. Ratios and speeds are those of ROOT's codecs on
+ * the same flat values the other compressors see, not those of the file's baskets.
+ *
+ * Instantiated for float, double, int32_t and char; compression is lossless for all of them.
+ */
+template <typename T>
+class RootCompressor : public Compressor<T> {
+public:
+    /**
+     * @brief Construct a RootCompressor given values.
+     * @param algorithm ROOT compression algorithm: zlib, lzma, lz4 or zstd.
+     * @param compressionLevel Compression level, 1-9.
+     */
+    RootCompressor(const std::string& algorithm, int compressionLevel);
+
+    /**
+     * @brief Construct a RootCompressor from configuration map.
+     * @param config Map of configuration options.
+     * Keys:
+     *  "algorithm" - ROOT compression algorithm: zlib, lzma, lz4 or zstd.
+     *  "compressionLevel" - compression level (int, 1-9).
+     */
+    RootCompressor(const std::map<std::string, std::string>& config);
+
+    /** Setters and getters for the algorithm and compression level. */
+    void setAlgorithm(const std::string& algorithm);
+    std::string getAlgorithm() const;
+    void setCompressionLevel(int level);
+    int getCompressionLevel() const;
+
+    std::string toString() const override;
+    std::map<std::string, std::string> getConfig() const override;
+    size_t compressBound(size_t numElements) const override;
+
+    /**
+     * @brief Compress input data.
+     * @param data Uncompressed data to compress.
+     * @param compressed CompressedData receiving the compressed result.
+     */
+    void compress(std::span<const T> data, CompressedData& compressed) override;
+
+    /**
+     * @brief Decompress input data.
+     * @param compressedData Compressed data to decompress.
+     * @param output Buffer of compressedData.numElements elements receiving the decompressed result.
+     */
+    void decompress(const CompressedData& compressedData, std::span<T> output) override;
+
+private:
+    std::string algorithm_ = "zlib";    ///< ROOT compression algorithm name
+    int compressionLevel_ = 1;          ///< Compression level of the algorithm
+    int settings_ = 101;                ///< ROOT compression settings, algorithm * 100 + level
+
+    /**
+     * @brief Validate an algorithm and level and update the compression settings.
+     */
+    void resetSettings(const std::string& algorithm, int compressionLevel);
+};
@@ -4,9 +4,31 @@
  * @brief Implementation of SZ3Compressor for scientific data compression using SZ3 library.
  */
 #include "SZ3Compressor.hpp"
+#include <type_traits>
+#include <format>
 #include <SZ3/api/sz.hpp>
 
-SZ3Compressor::SZ3Compressor(SZ3::ALGO algorithm, SZ3::EB errorBoundMode, double errorBound)
+namespace {
+
+/**
+ * @brief SZ3 data type tag for an element type.
+ */
+template <typename T>
+constexpr int sz3DataType() {
+    if constexpr (std::is_same_v<T, float>) {
+        return SZ_FLOAT;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return SZ_DOUBLE;
+    } else {
+        static_assert(std::is_same_v<T, int32_t>, "SZ3Compressor supports float, double and int32_t");
+        return SZ_INT32;
+    }
+}
+
+} // namespace
+
+template <typename T>
+SZ3Compressor<T>::SZ3Compressor(SZ3::ALGO algorithm, SZ3::EB errorBoundMode, double errorBound)
     : algorithm_(algorithm), errorBoundMode_(errorBoundMode), errorBound_(errorBound)
 {
     setAlgorithm(algorithm);
@@ -14,7 +36,8 @@ SZ3Compressor::SZ3Compressor(SZ3::ALGO algorithm, SZ3::EB errorBoundMode, double
     setErrorBound(errorBound);
 }
 
-SZ3Compressor::SZ3Compressor(const std::map<std::string, std::string>& options) {
+template <typename T>
+SZ3Compressor<T>::SZ3Compressor(const std::map<std::string, std::string>& options) {
     // Parse options
     auto it = options.find("algorithm");
     if (it != options.end()) {
@@ -38,7 +61,8 @@ SZ3Compressor::SZ3Compressor(const std::map<std::string, std::string>& options)
     }
 }
 
-void SZ3Compressor::setAlgorithm(SZ3::ALGO algorithm) {
+template <typename T>
+void SZ3Compressor<T>::setAlgorithm(SZ3::ALGO algorithm) {
     switch(algorithm) {
         case SZ3::ALGO_LORENZO_REG:
         case SZ3::ALGO_INTERP_LORENZO:
@@ -50,13 +74,16 @@ void SZ3Compressor::setAlgorithm(SZ3::ALGO algorithm) {
             throw std::invalid_argument("Invalid or unsupported algorithm value: " + std::to_string(algorithm));
     }
     algorithm_ = algorithm;
+    config_.reset();
 }
 
-SZ3::ALGO SZ3Compressor::getAlgorithm() const {
+template <typename T>
+SZ3::ALGO SZ3Compressor<T>::getAlgorithm() const {
     return algorithm_;
 }
 
-void SZ3Compressor::setErrorBoundMode(SZ3::EB errorBoundMode) {
+template <typename T>
+void SZ3Compressor<T>::setErrorBoundMode(SZ3::EB errorBoundMode) {
     switch(errorBoundMode) {
         case SZ3::EB_ABS:
         case SZ3::EB_REL:
@@ -65,28 +92,35 @@ void SZ3Compressor::setErrorBoundMode(SZ3::EB errorBoundMode) {
             throw std::invalid_argument("Invalid or unsupported errorBoundMode value: " + std::to_string(errorBoundMode));
     }
     errorBoundMode_ = errorBoundMode;
+    config_.reset();
 }
 
-SZ3::EB SZ3Compressor::getErrorBoundMode() const {
+template <typename T>
+SZ3::EB SZ3Compressor<T>::getErrorBoundMode() const {
     return errorBoundMode_;
 }
 
-void SZ3Compressor::setErrorBound(double errorBound) {
+template <typename T>
+void SZ3Compressor<T>::setErrorBound(double errorBound) {
     if (errorBound <= 0) {
         throw std::invalid_argument("Error bound must be positive");
     }
     errorBound_ = errorBound;
+    config_.reset();
 }
 
-double SZ3Compressor::getErrorBound() const {
+template <typename T>
+double SZ3Compressor<T>::getErrorBound() const {
     return errorBound_;
 }
 
-std::string SZ3Compressor::toString() const {
+template <typename T>
+std::string SZ3Compressor<T>::toString() const {
     return std::format("SZ3Compressor({},{},{})", static_cast<int>(algorithm_), static_cast<int>(errorBoundMode_), errorBound_);
 }
 
-std::map<std::string, std::string> SZ3Compressor::getConfig() const {
+template <typename T>
+std::map<std::string, std::string> SZ3Compressor<T>::getConfig() const {
     return {
         {"algorithm", std::to_string(static_cast<int>(algorithm_))},
         {"errorBoundMode", std::to_string(static_cast<int>(errorBoundMode_))},
@@ -94,62 +128,67 @@ std::map<std::string, std::string> SZ3Compressor::getConfig() const {
     };
 }
 
-CompressedData SZ3Compressor::compress(const std::vector<float>& data) {
-    // Make config
-    SZ3::Config config = makeConfig({data.size()});
+template <typename T>
+size_t SZ3Compressor<T>::compressBound(size_t numElements) const {
+    return SZ_compress_size_bound<T>(makeConfig({numElements}));
+}
 
-    // Compress
-    size_t cmpSize = 0;
-    char* cmpData{};
+template <typename T>
+void SZ3Compressor<T>::compress(std::span<const T> data, CompressedData& compressed) {
+    const SZ3::Config& config = cachedConfig(data.size());
 
-    cmpData = SZ_compress(
+    // Compress straight into the caller's buffer, which is only grown when too small
+    size_t cmpCap = SZ_compress_size_bound<T>(config);
+    if (compressed.data.size() < cmpCap) {
+        compressed.data.resize(cmpCap);
+    }
+
+    size_t cmpSize = SZ_compress(
         config,
         data.data(),
-        cmpSize
+        reinterpret_cast<char*>(compressed.data.data()),
+        compressed.data.size()
     );
 
-    if (!cmpData) {
-        throw std::runtime_error("SZ_compress failed to allocate output buffer");
+    if (cmpSize == 0) {
+        throw std::runtime_error("SZ_compress failed");
     }
 
-    // Move compressed data to CompressedData struct
-    std::vector<uint8_t> compressedData(cmpData, cmpData + cmpSize);
-
-    // Free the compressed data pointer
-    free(cmpData);
-
-    return CompressedData{std::move(compressedData), data.size(), getConfig()};
+    compressed.numBytes = cmpSize;
+    compressed.numElements = data.size();
 }
 
-std::vector<float> SZ3Compressor::decompress(const CompressedData& compressed) {
-    // Make config
-    SZ3::Config config = makeConfig({compressed.numFloats});
+template <typename T>
+void SZ3Compressor<T>::decompress(const CompressedData& compressed, std::span<T> output) {
+    if (output.size() < compressed.numElements) {
+        throw std::invalid_argument("Output buffer too small for decompressed data");
+    }
 
-    // Allocate output buffer
-    float* dec_data_p = nullptr;
+    // SZ_decompress writes into a non-null output pointer instead of allocating
+    T* dec_data_p = output.data();
 
-    // Call SZ_decompress
+    // SZ_decompress fills the config from the compressed header, so one config serves every chunk
     SZ_decompress(
-        config,
+        decompressConfig_,
         reinterpret_cast<const char*>(compressed.data.data()),
-        compressed.data.size(), // Pass compressed buffer size in bytes
+        compressed.numBytes, // Pass compressed buffer size in bytes
         dec_data_p
     );
+}
 
-    if (!dec_data_p) {
-        throw std::runtime_error("SZ_decompress failed to allocate output buffer");
+template <typename T>
+const SZ3::Config& SZ3Compressor<T>::cachedConfig(size_t numElements) {
+    if (!config_ || config_->num != numElements) {
+        config_ = makeConfig({numElements});
     }
-
-    std::vector<float> dec_data(dec_data_p, dec_data_p + compressed.numFloats);
-    free(dec_data_p); // Free the decompressed data pointer
-
-    return dec_data;
+    return *config_;
 }
 
-SZ3::Config SZ3Compressor::makeConfig(std::vector<size_t> dims) {
+template <typename T>
+SZ3::Config SZ3Compressor<T>::makeConfig(std::vector<size_t> dims) const {
     SZ3::Config config = SZ3::Config({dims[0]});
     
-    config.dataType = SZ_FLOAT;
+    config.dataType = sz3DataType<T>();
     config.cmprAlgo = algorithm_;
     config.errorBoundMode = errorBoundMode_;
     if (errorBoundMode_ == SZ3::EB_ABS) {
@@ -160,3 +199,7 @@ SZ3::Config SZ3Compressor::makeConfig(std::vector<size_t> dims) {
 
     return config;
 }
+
+template class SZ3Compressor<float>;
+template class SZ3Compressor<double>;
+template class SZ3Compressor<int32_t>;
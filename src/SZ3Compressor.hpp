@@ -7,16 +7,23 @@
 #pragma once
 
 #include "Compressor.hpp"
+#include <span>
 #include <vector>
 #include <memory>
+#include <optional>
 #include <SZ3/utils/Config.hpp>
 // #include <SZ3/api/sz.hpp>
 
 /**
  * @class SZ3Compressor
  * @brief Compressor using the SZ3 library for scientific data.
+ *
+ * Instantiated for float, double and int32_t, the element types SZ3 supports.
+ * The SZ3 configuration is kept between calls and only rebuilt when the chunk size or a
+ * setting changes, and SZ3 compresses straight into the caller's preallocated buffer.
  */
-class SZ3Compressor : public Compressor {
+template <typename T>
+class SZ3Compressor : public Compressor<T> {
 public:
     /**
      * @brief Construct an SZ3Compressor.
@@ -35,20 +42,21 @@ public:
 
     std::string toString() const override;
     std::map<std::string, std::string> getConfig() const override;
+    size_t compressBound(size_t numElements) const override;
 
     /**
      * @brief Compress input data.
      * @param data Uncompressed data to compress.
-     * @return CompressedData containing compressed result.
+     * @param compressed CompressedData receiving the compressed result.
      */
-    CompressedData compress(const std::vector<float>& data) override;
+    void compress(std::span<const T> data, CompressedData& compressed) override;
 
     /**
      * @brief Decompress input data.
      * @param compressed Compressed data to decompress.
-     * @return std::vector<float> containing decompressed result.
+     * @param output Buffer of compressed.numElements elements receiving the decompressed result.
      */
-    std::vector<float> decompress(const CompressedData& compressed) override;
+    void decompress(const CompressedData& compressed, std::span<T> output) override;
 
 private:
     SZ3::EB errorBoundMode_;        ///< Error bound mode
@@ -56,5 +64,13 @@ private:
     SZ3::INTERP_ALGO interpAlgo_;   ///< Interpolation algorithm
     double errorBound_;             ///< Error bound value
 
-    SZ3::Config makeConfig(std::vector<size_t> dims);
+    std::optional<SZ3::Config> config_;     ///< Compression config of the last chunk size, reset by the setters
+    SZ3::Config decompressConfig_;          ///< Config SZ_decompress reads each chunk's header into
+
+    SZ3::Config makeConfig(std::vector<size_t> dims) const;
+
+    /**
+     * @brief Compression config for a chunk of numElements elements, reused while the size is unchanged.
+     */
+    const SZ3::Config& cachedConfig(size_t numElements);
 };
\ No newline at end of file
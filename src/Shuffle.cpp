@@ -0,0 +1,337 @@
+/**
+ * @file Shuffle.cpp
+ * @brief Scalar and AVX2 byte-shuffle and bit-shuffle transposes.
+ *
+ * The bit plane layout follows Blosc's bitshuffle: values are byte-shuffled, then the
+ * byte stream of each significance k is split into 8 bit planes, so output plane 8k+j
+ * holds bit j of byte k of every value, 8 values per byte, lowest value in bit 0.
+ */
+#include "Shuffle.hpp"
+#include "TruncKernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SHUFFLE_X86 1
+#include <immintrin.h>
+#else
+#define SHUFFLE_X86 0
+#endif
+
+namespace {
+
+/** Values per block of the bit shuffle; a multiple of 32 so AVX2 handles whole blocks. */
+constexpr size_t bitShuffleBlock = 1024;
+
+/**
+ * @brief Transpose an 8x8 bit matrix held as 8 bytes (Hacker's Delight, transpose8).
+ *
+ * Bit c of byte r moves to bit r of byte c. The transpose is its own inverse.
+ */
+uint64_t transposeBits8x8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+void shuffleBytesScalar(const uint8_t* input, uint8_t* output, size_t numValues, size_t typeSize, size_t first) {
+    for (size_t k = 0; k < typeSize; ++k) {
+        for (size_t i = first; i < numValues; ++i) {
+            output[k * numValues + i] = input[i * typeSize + k];
+        }
+    }
+}
+
+void unshuffleBytesScalar(const uint8_t* input, uint8_t* output, size_t numValues, size_t typeSize, size_t first) {
+    for (size_t k = 0; k < typeSize; ++k) {
+        for (size_t i = first; i < numValues; ++i) {
+            output[i * typeSize + k] = input[k * numValues + i];
+        }
+    }
+}
+
+/**
+ * @brief Split a byte stream of numBytes values (a multiple of 8) into 8 bit planes.
+ */
+void splitBitPlanesScalar(const uint8_t* stream, uint8_t* planes, size_t planeStride, size_t numBytes, size_t first) {
+    for (size_t q = first / 8; q < numBytes / 8; ++q) {
+        uint64_t x = 0;
+        for (int k = 0; k < 8; ++k) {
+            x |= uint64_t{stream[8 * q + k]} << (8 * k);
+        }
+        x = transposeBits8x8(x);
+        for (int j = 0; j < 8; ++j) {
+            planes[j * planeStride + q] = static_cast<uint8_t>(x >> (8 * j));
+        }
+    }
+}
+
+void joinBitPlanesScalar(const uint8_t* planes, uint8_t* stream, size_t planeStride, size_t numBytes, size_t first) {
+    for (size_t q = first / 8; q < numBytes / 8; ++q) {
+        uint64_t x = 0;
+        for (int j = 0; j < 8; ++j) {
+            x |= uint64_t{planes[j * planeStride + q]} << (8 * j);
+        }
+        x = transposeBits8x8(x);
+        for (int k = 0; k < 8; ++k) {
+            stream[8 * q + k] = static_cast<uint8_t>(x >> (8 * k));
+        }
+    }
+}
+
+#if SHUFFLE_X86
+
+/**
+ * @brief Byte shuffle of 4-byte values, 8 values per iteration.
+ * @return Number of values handled; the caller finishes the rest.
+ */
+__attribute__((target("avx2")))
+size_t shuffleBytes4AVX2(const uint8_t* input, uint8_t* output, size_t numValues) {
+    // Within each 128-bit lane, gather byte k of the lane's 4 values into dword k,
+    // then interleave the lanes so qword k holds byte k of all 8 values
+    const __m256i gather = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+                                            0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i interleave = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    size_t i = 0;
+    for (; i + 8 <= numValues; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 4 * i));
+        v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, gather), interleave);
+        __m128i lo = _mm256_castsi256_si128(v);
+        __m128i hi = _mm256_extracti128_si256(v, 1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i), lo);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + numValues + i), _mm_unpackhi_epi64(lo, lo));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 2 * numValues + i), hi);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 3 * numValues + i), _mm_unpackhi_epi64(hi, hi));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t unshuffleBytes4AVX2(const uint8_t* input, uint8_t* output, size_t numValues) {
+    // Inverse of shuffleBytes4AVX2; the 4x4 byte transpose within a lane is its own inverse
+    const __m256i scatter = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+                                             0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    size_t i = 0;
+    for (; i + 8 <= numValues; i += 8) {
+        __m128i lo = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i)),
+                                        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + numValues + i)));
+        __m128i hi = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 2 * numValues + i)),
+                                        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 3 * numValues + i)));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        v = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v, deinterleave), scatter);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 4 * i), v);
+    }
+    return i;
+}
+
+/**
+ * @brief Split 32 bytes at a time into bit planes, taking the top bit of every byte with movemask.
+ * @return Number of bytes handled; the caller finishes the rest.
+ */
+__attribute__((target("avx2")))
+size_t splitBitPlanesAVX2(const uint8_t* stream, uint8_t* planes, size_t planeStride, size_t numBytes) {
+    size_t k = 0;
+    for (; k + 32 <= numBytes; k += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stream + k));
+        for (int j = 7; j >= 0; --j) {
+            uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+            std::memcpy(planes + j * planeStride + k / 8, &bits, sizeof(bits));
+            v = _mm256_add_epi8(v, v);
+        }
+    }
+    return k;
+}
+
+__attribute__((target("avx2")))
+size_t joinBitPlanesAVX2(const uint8_t* planes, uint8_t* stream, size_t planeStride, size_t numBytes) {
+    // Broadcast byte k/8 of a 32-bit plane word to byte k, then test bit k%8
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i select = _mm256_set1_epi64x(static_cast<int64_t>(0x8040201008040201ULL));
+
+    size_t k = 0;
+    for (; k + 32 <= numBytes; k += 32) {
+        __m256i bytes = _mm256_setzero_si256();
+        for (int j = 0; j < 8; ++j) {
+            uint32_t bits;
+            std::memcpy(&bits, planes + j * planeStride + k / 8, sizeof(bits));
+            __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int32_t>(bits)), spread);
+            v = _mm256_cmpeq_epi8(_mm256_and_si256(v, select), select);
+            bytes = _mm256_or_si256(bytes, _mm256_and_si256(v, _mm256_set1_epi8(static_cast<char>(1 << j))));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(stream + k), bytes);
+    }
+    return k;
+}
+
+#endif // SHUFFLE_X86
+
+bool useAVX2() {
+    return detectSimdLevel() >= SimdLevel::AVX2;
+}
+
+void shuffleBytes(const uint8_t* input, uint8_t* output, size_t numValues, size_t typeSize) {
+    size_t first = 0;
+#if SHUFFLE_X86
+    if (typeSize == 4 && useAVX2()) {
+        first = shuffleBytes4AVX2(input, output, numValues);
+    }
+#endif
+    shuffleBytesScalar(input, output, numValues, typeSize, first);
+}
+
+void unshuffleBytes(const uint8_t* input, uint8_t* output, size_t numValues, size_t typeSize) {
+    size_t first = 0;
+#if SHUFFLE_X86
+    if (typeSize == 4 && useAVX2()) {
+        first = unshuffleBytes4AVX2(input, output, numValues);
+    }
+#endif
+    unshuffleBytesScalar(input, output, numValues, typeSize, first);
+}
+
+void splitBitPlanes(const uint8_t* stream, uint8_t* planes, size_t planeStride, size_t numBytes) {
+    size_t first = 0;
+#if SHUFFLE_X86
+    if (useAVX2()) {
+        first = splitBitPlanesAVX2(stream, planes, planeStride, numBytes);
+    }
+#endif
+    splitBitPlanesScalar(stream, planes, planeStride, numBytes, first);
+}
+
+void joinBitPlanes(const uint8_t* planes, uint8_t* stream, size_t planeStride, size_t numBytes) {
+    size_t first = 0;
+#if SHUFFLE_X86
+    if (useAVX2()) {
+        first = joinBitPlanesAVX2(planes, stream, planeStride, numBytes);
+    }
+#endif
+    joinBitPlanesScalar(planes, stream, planeStride, numBytes, first);
+}
+
+/**
+ * @brief Per-thread scratch for one block of byte-shuffled values, reused across calls.
+ */
+uint8_t* blockScratch(size_t numBytes) {
+    thread_local std::vector<uint8_t> scratch;
+    if (scratch.size() < numBytes) {
+        scratch.resize(numBytes);
+    }
+    return scratch.data();
+}
+
+void bitShuffle(const uint8_t* input, uint8_t* output, size_t numValues, size_t typeSize) {
+    // Whole groups of 8 values go to bit planes of planeStride bytes each
+    size_t numPlaned = numValues - numValues % 8;
+    size_t planeStride = numPlaned / 8;
+    uint8_t* block = blockScratch(bitShuffleBlock * typeSize);
+
+    // Byte-shuffle a cache-sized block of values, then split each of its byte streams
+    for (size_t start = 0; start < numPlaned; start += bitShuffleBlock) {
+        size_t count = std::min(bitShuffleBlock, numPlaned - start);
+        shuffleBytes(input + start * typeSize, block, count, typeSize);
+        for (size_t k = 0; k < typeSize; ++k) {
+            splitBitPlanes(block + k * count, output + 8 * k * planeStride + start / 8, planeStride, count);
+        }
+    }
+
+    // Leftover values are stored as they are
+    std::memcpy(output + numPlaned * typeSize, input + numPlaned * typeSize, (numValues - numPlaned) * typeSize);
+}
+
+void bitUnshuffle(const uint8_t* input, uint8_t* output, size_t numValues, size_t typeSize) {
+    size_t numPlaned = numValues - numValues % 8;
+    size_t planeStride = numPlaned / 8;
+    uint8_t* block = blockScratch(bitShuffleBlock * typeSize);
+
+    for (size_t start = 0; start < numPlaned; start += bitShuffleBlock) {
+        size_t count = std::min(bitShuffleBlock, numPlaned - start);
+        for (size_t k = 0; k < typeSize; ++k) {
+            joinBitPlanes(input + 8 * k * planeStride + start / 8, block + k * count, planeStride, count);
+        }
+        unshuffleBytes(block, output + start * typeSize, count, typeSize);
+    }
+
+    std::memcpy(output + numPlaned * typeSize, input + numPlaned * typeSize, (numValues - numPlaned) * typeSize);
+}
+
+void checkSizes(std::span<const uint8_t> input, std::span<uint8_t> output, size_t typeSize) {
+    if (typeSize == 0 || input.size() % typeSize != 0) {
+        throw std::invalid_argument("Shuffle input must be a whole number of values");
+    }
+    if (output.size() != input.size()) {
+        throw std::invalid_argument("Shuffle output must have the same size as its input");
+    }
+}
+
+} // namespace
+
+ShuffleMode parseShuffleMode(const std::string& name) {
+    if (name == "none") {
+        return ShuffleMode::None;
+    } else if (name == "byte") {
+        return ShuffleMode::Byte;
+    } else if (name == "bit") {
+        return ShuffleMode::Bit;
+    } else {
+        throw std::invalid_argument("Unknown shuffle mode: " + name);
+    }
+}
+
+std::string shuffleModeName(ShuffleMode mode) {
+    switch (mode) {
+        case ShuffleMode::None:
+            return "none";
+        case ShuffleMode::Byte:
+            return "byte";
+        case ShuffleMode::Bit:
+            return "bit";
+    }
+    throw std::invalid_argument("Unknown shuffle mode");
+}
+
+void shuffle(std::span<const uint8_t> input, std::span<uint8_t> output, size_t typeSize, ShuffleMode mode) {
+    checkSizes(input, output, typeSize);
+    size_t numValues = input.size() / typeSize;
+
+    switch (mode) {
+        case ShuffleMode::None:
+            std::copy(input.begin(), input.end(), output.begin());
+            return;
+        case ShuffleMode::Byte:
+            shuffleBytes(input.data(), output.data(), numValues, typeSize);
+            return;
+        case ShuffleMode::Bit:
+            bitShuffle(input.data(), output.data(), numValues, typeSize);
+            return;
+    }
+}
+
+void unshuffle(std::span<const uint8_t> input, std::span<uint8_t> output, size_t typeSize, ShuffleMode mode) {
+    checkSizes(input, output, typeSize);
+    size_t numValues = input.size() / typeSize;
+
+    switch (mode) {
+        case ShuffleMode::None:
+            std::copy(input.begin(), input.end(), output.begin());
+            return;
+        case ShuffleMode::Byte:
+            unshuffleBytes(input.data(), output.data(), numValues, typeSize);
+            return;
+        case ShuffleMode::Bit:
+            bitUnshuffle(input.data(), output.data(), numValues, typeSize);
+            return;
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file Shuffle.hpp
+ * @brief Byte-shuffle and bit-shuffle transposes applied before a lossless backend.
+ *
+ * After mantissa truncation the low bytes (and bits) of every value are zero, but they
+ * are interleaved with the high ones. Transposing the buffer groups equal-significance
+ * bytes or bits of all values together, so the backend sees long runs it can compress.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+/**
+ * @brief Transpose applied between truncation and the lossless backend.
+ */
+enum class ShuffleMode {
+    None,       ///< Values are passed to the backend as they are
+    Byte,       ///< Byte k of every value, for each k in turn
+    Bit         ///< Bit j of byte k of every value, for each k and j in turn
+};
+
+/**
+ * @brief Parse a shuffle mode from "none", "byte" or "bit".
+ * @throws std::invalid_argument if the name is unknown.
+ */
+ShuffleMode parseShuffleMode(const std::string& name);
+
+/**
+ * @brief Name of a shuffle mode ("none", "byte" or "bit").
+ */
+std::string shuffleModeName(ShuffleMode mode);
+
+/**
+ * @brief Transpose input, made of values of typeSize bytes, into output.
+ *
+ * Byte shuffle writes byte k of every value as one contiguous stream, for k = 0..typeSize-1.
+ * Bit shuffle further splits each byte stream into 8 bit planes; values beyond the last
+ * multiple of 8 are copied unchanged at the end. With None, input is copied.
+ *
+ * @param input Values to transpose, as bytes (a multiple of typeSize).
+ * @param output Buffer of input.size() bytes; must not overlap input.
+ * @param typeSize Size of one value, in bytes.
+ * @param mode Transpose to apply.
+ * @throws std::invalid_argument if the sizes do not match.
+ */
+void shuffle(std::span<const uint8_t> input, std::span<uint8_t> output, size_t typeSize, ShuffleMode mode);
+
+/**
+ * @brief Undo shuffle() with the same typeSize and mode.
+ * @param input Transposed bytes.
+ * @param output Buffer of input.size() bytes receiving the values; must not overlap input.
+ */
+void unshuffle(std::span<const uint8_t> input, std::span<uint8_t> output, size_t typeSize, ShuffleMode mode);
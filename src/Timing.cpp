@@ -0,0 +1,128 @@
+/**
+ * @file Timing.cpp
+ * @brief Implementation of the timing clocks and trial statistics.
+ */
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include <time.h>
+
+#include "Timing.hpp"
+
+namespace {
+
+/**
+ * @brief Percentile q (in [0,1]) of sorted values, interpolated between neighbours.
+ */
+double percentile(const std::vector<double>& sorted, double q) {
+    double position = q * (sorted.size() - 1);
+    size_t below = static_cast<size_t>(position);
+    size_t above = std::min(below + 1, sorted.size() - 1);
+    return sorted[below] + (position - below) * (sorted[above] - sorted[below]);
+}
+
+} // namespace
+
+TimingClock parseTimingClock(const std::string& name) {
+    if (name == "wall") {
+        return TimingClock::Wall;
+    } else if (name == "cpu") {
+        return TimingClock::ThreadCPU;
+    }
+    throw std::invalid_argument("Unknown timing clock: " + name + " (expected wall or cpu)");
+}
+
+std::string timingClockName(TimingClock clock) {
+    return (clock == TimingClock::Wall) ? "wall" : "cpu";
+}
+
+double clockMs(TimingClock clock) {
+    if (clock == TimingClock::ThreadCPU) {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ThroughputStats summarizeThroughputs(const std::vector<double>& trials) {
+    ThroughputStats stats;
+    stats.trials = trials;
+    if (trials.empty()) {
+        return stats;
+    }
+
+    std::vector<double> sorted = trials;
+    std::sort(sorted.begin(), sorted.end());
+    stats.median = percentile(sorted, 0.5);
+    stats.p5 = percentile(sorted, 0.05);
+    stats.p95 = percentile(sorted, 0.95);
+    stats.min = sorted.front();
+    stats.max = sorted.back();
+    stats.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+    if (sorted.size() > 1) {
+        double sumSquares = 0.0;
+        for (double value : sorted) {
+            sumSquares += (value - stats.mean) * (value - stats.mean);
+        }
+        stats.stddev = std::sqrt(sumSquares / (sorted.size() - 1));
+    }
+    return stats;
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t ns) {
+    if (ns < kSubBuckets) {
+        return ns;
+    }
+    // Octave from the highest set bit, sub-bucket from the two bits below it
+    size_t exponent = std::bit_width(ns) - 1;
+    size_t sub = (ns >> (exponent - 2)) & (kSubBuckets - 1);
+    return kSubBuckets * (exponent - 1) + sub;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    size_t exponent = bucket / kSubBuckets + 1;
+    size_t sub = bucket % kSubBuckets;
+    return (kSubBuckets + sub) << (exponent - 2);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    ++buckets_[bucketOf(ns)];
+    ++count_;
+    max_ = std::max(max_, ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+        buckets_[bucket] += other.buckets_[bucket];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+}
+
+double LatencyHistogram::percentile(double q) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+
+    // Rank of the requested latency, 1-based
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count_)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+        seen += buckets_[bucket];
+        if (seen >= rank) {
+            double lower = static_cast<double>(bucketLowerBound(bucket));
+            double upper = (bucket + 1 < kNumBuckets) ? static_cast<double>(bucketLowerBound(bucket + 1)) : lower * 1.25;
+            return std::min((lower + upper) / 2.0, static_cast<double>(max_));
+        }
+    }
+    return static_cast<double>(max_);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file Timing.hpp
+ * @brief Clocks used to time compression, and statistics over repeated trials.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Clock used to time compress and decompress calls.
+ */
+enum class TimingClock {
+    Wall,       ///< Monotonic wall-clock time (std::chrono::steady_clock)
+    ThreadCPU   ///< CPU time of the calling thread (CLOCK_THREAD_CPUTIME_ID), blind to preemption and I/O waits
+};
+
+/**
+ * @brief Parse a timing clock from "wall" or "cpu".
+ * @throws std::invalid_argument if the name is unknown.
+ */
+TimingClock parseTimingClock(const std::string& name);
+
+/**
+ * @brief Name of a timing clock ("wall" or "cpu").
+ */
+std::string timingClockName(TimingClock clock);
+
+/**
+ * @brief Current reading of a clock, in milliseconds from an arbitrary origin.
+ *
+ * Only differences between readings taken on the same thread are meaningful.
+ */
+double clockMs(TimingClock clock);
+
+/**
+ * @brief Summary of the throughputs measured over repeated trials.
+ */
+struct ThroughputStats {
+    double median{};
+    double p5{};            // 5th percentile (linearly interpolated)
+    double p95{};           // 95th percentile (linearly interpolated)
+    double mean{};
+    double stddev{};        // Sample standard deviation (0 for a single trial)
+    double min{};
+    double max{};
+    std::vector<double> trials{};   // Throughput of each trial, in the order they ran
+};
+
+/**
+ * @brief Summarize the throughputs of repeated trials.
+ * @param trials Throughput of each trial, in MB/s.
+ * @return Statistics of the trials (all zero if there are none).
+ */
+ThroughputStats summarizeThroughputs(const std::vector<double>& trials);
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-bucketed histogram of per-call latencies, in nanoseconds.
+ *
+ * Each power of two is split into kSubBuckets buckets, so any latency from 1 ns to
+ * centuries lands in a fixed array of kNumBuckets counts with at most 25% relative
+ * bucket width. Recording is a few integer operations and never allocates, so it can
+ * stay on for every chunk of a multi-GB run; histograms of different threads or runs merge
+ * by adding counts.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 4;                ///< Buckets per power of two
+    static constexpr size_t kNumBuckets = 64 * kSubBuckets; ///< Enough for any 64-bit latency
+
+    /**
+     * @brief Record one latency.
+     */
+    void record(uint64_t ns);
+
+    /**
+     * @brief Add the counts of another histogram.
+     */
+    void merge(const LatencyHistogram& other);
+
+    /** Number of latencies recorded. */
+    uint64_t count() const { return count_; }
+
+    /** Largest latency recorded, exactly. */
+    uint64_t max() const { return max_; }
+
+    /**
+     * @brief Approximate latency at quantile q in [0,1]: the middle of the bucket holding
+     *        that rank, capped at max() (0 if empty).
+     */
+    double percentile(double q) const;
+
+    /** Count of each bucket. */
+    const std::array<uint64_t, kNumBuckets>& buckets() const { return buckets_; }
+
+    /** Smallest latency that falls in a bucket. */
+    static uint64_t bucketLowerBound(size_t bucket);
+
+    /** Bucket a latency falls in. */
+    static size_t bucketOf(uint64_t ns);
+
+private:
+    std::array<uint64_t, kNumBuckets> buckets_{};
+    uint64_t count_{};
+    uint64_t max_{};
+};
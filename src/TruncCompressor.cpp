@@ -1,27 +1,55 @@
-
 /**
  * @file TruncCompressor.cpp
- * @brief Implementation of TruncCompressor for lossy float compression using mantissa truncation and zlib.
+ * @brief Implementation of TruncCompressor for lossy floating-point compression using mantissa truncation and a lossless backend.
  */
 #include "TruncCompressor.hpp"
+#include "TruncKernels.hpp"
 #include <format>
 #include <stdexcept>
-#include <zlib.h>
 #include <cstring>
 #include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+/**
+ * @brief Number of explicit mantissa bits of T (23 for float, 52 for double, 0 for integers).
+ */
+template <typename T>
+constexpr int mantissaDigits() {
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::numeric_limits<T>::digits - 1;
+    } else {
+        return 0;
+    }
+}
+
+} // namespace
 
-TruncCompressor::TruncCompressor(int compressionLevel, int mantissaBits) {
-    setCompressionLevel(compressionLevel);
+template <typename T>
+TruncCompressor<T>::TruncCompressor(int compressionLevel, int mantissaBits, const std::string& backend,
+                                    ShuffleMode shuffle) {
+    resetBackend(backend, compressionLevel);
     setMantissaBits(mantissaBits);
+    setShuffle(shuffle);
 }
 
-TruncCompressor::TruncCompressor(const std::map<std::string, std::string>& config) {
+template <typename T>
+TruncCompressor<T>::TruncCompressor(const std::map<std::string, std::string>& config) {
     auto it = config.find("compressionLevel");
-    if (it != config.end()) {
-        setCompressionLevel(std::stoi(it->second));
-    } else {
+    if (it == config.end()) {
         throw std::invalid_argument("compressionLevel is required in TruncCompressor config");
     }
+    int compressionLevel = std::stoi(it->second);
+
+    it = config.find("backend");
+    resetBackend(it != config.end() ? it->second : "zlib", compressionLevel);
+
+    it = config.find("shuffle");
+    if (it != config.end()) {
+        setShuffle(parseShuffleMode(it->second));
+    }
 
     it = config.find("mantissaBits");
     if (it != config.end()) {
@@ -31,94 +59,141 @@ TruncCompressor::TruncCompressor(const std::map<std::string, std::string>& confi
     }
 }
 
-void TruncCompressor::setMantissaBits(int mantissaBits) {
-    if (mantissaBits < 0 || mantissaBits > 23) {
-        throw std::invalid_argument("mantissaBits must be in [0,23]");
+template <typename T>
+void TruncCompressor<T>::setMantissaBits(int mantissaBits) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (mantissaBits < 0 || mantissaBits > mantissaDigits<T>()) {
+            throw std::invalid_argument(std::format("mantissaBits must be in [0,{}]", mantissaDigits<T>()));
+        }
+    } else if (mantissaBits < 0) {
+        throw std::invalid_argument("mantissaBits must be non-negative");
     }
     mantissaBits_ = mantissaBits;
 }
 
-int TruncCompressor::getMantissaBits() const {
+template <typename T>
+int TruncCompressor<T>::getMantissaBits() const {
     return mantissaBits_;
 }
 
-void TruncCompressor::setCompressionLevel(int level) {
-    if (level < 0 || level > 9) {
-        throw std::invalid_argument("compressionLevel must be in [0,9]");
-    }
-    compressionLevel_ = level;
+template <typename T>
+void TruncCompressor<T>::setCompressionLevel(int level) {
+    resetBackend(getBackend(), level);
 }
 
-int TruncCompressor::getCompressionLevel() const {
+template <typename T>
+int TruncCompressor<T>::getCompressionLevel() const {
     return compressionLevel_;
 }
 
-std::string TruncCompressor::toString() const {
-    return std::format("TruncCompressor({},{})", mantissaBits_, compressionLevel_);
+template <typename T>
+void TruncCompressor<T>::setBackend(const std::string& backend) {
+    resetBackend(backend, compressionLevel_);
+}
+
+template <typename T>
+std::string TruncCompressor<T>::getBackend() const {
+    return backend_ ? backend_->name() : "zlib";
+}
+
+template <typename T>
+void TruncCompressor<T>::setShuffle(ShuffleMode shuffle) {
+    shuffle_ = shuffle;
+}
+
+template <typename T>
+ShuffleMode TruncCompressor<T>::getShuffle() const {
+    return shuffle_;
+}
+
+template <typename T>
+void TruncCompressor<T>::resetBackend(const std::string& backend, int compressionLevel) {
+    backend_ = makeLosslessBackend(backend, compressionLevel);
+    compressionLevel_ = compressionLevel;
+}
+
+template <typename T>
+std::string TruncCompressor<T>::toString() const {
+    return std::format("TruncCompressor({},{},{},{})", mantissaBits_, compressionLevel_, getBackend(), shuffleModeName(shuffle_));
 }
 
-std::map<std::string, std::string> TruncCompressor::getConfig() const {
+template <typename T>
+std::map<std::string, std::string> TruncCompressor<T>::getConfig() const {
     return {
         {"mantissaBits", std::to_string(mantissaBits_)},
-        {"compressionLevel", std::to_string(compressionLevel_)}
+        {"compressionLevel", std::to_string(compressionLevel_)},
+        {"backend", getBackend()},
+        {"shuffle", shuffleModeName(shuffle_)}
     };
 }
 
-CompressedData TruncCompressor::compress(const std::vector<float>& data) {
-    std::vector<float> truncated{truncate_mantissas(data, mantissaBits_)};
+template <typename T>
+size_t TruncCompressor<T>::compressBound(size_t numElements) const {
+    return backend_->compressBound(numElements * sizeof(T));
+}
 
-    const uint8_t* input = reinterpret_cast<const uint8_t*>(truncated.data());
-    uLong input_size = truncated.size() * sizeof(float);
+template <typename T>
+void TruncCompressor<T>::compress(std::span<const T> data, CompressedData& compressed) {
+    if (truncated_.size() < data.size()) {
+        truncated_.resize(data.size());
+    }
+    std::span<T> truncated{truncated_.data(), data.size()};
+    truncate_mantissas(data, truncated, mantissaBits_);
 
-    uLongf output_size{compressBound(input_size)};
-    std::vector<uint8_t> output(output_size);
+    std::span<const uint8_t> input{reinterpret_cast<const uint8_t*>(truncated.data()), truncated.size() * sizeof(T)};
 
-    int res{::compress2(output.data(), &output_size, input, input_size, Z_BEST_COMPRESSION)};
-    if (res != Z_OK) {
-        throw std::runtime_error("zlib compress2 failed");
+    // Group bytes (or bits) of equal significance so the zeroed low bits form long runs
+    if (shuffle_ != ShuffleMode::None) {
+        if (shuffled_.size() < input.size()) {
+            shuffled_.resize(input.size());
+        }
+        std::span<uint8_t> shuffled{shuffled_.data(), input.size()};
+        shuffle(input, shuffled, sizeof(T), shuffle_);
+        input = shuffled;
     }
 
-    output.resize(output_size);
+    size_t output_size{backend_->compressBound(input.size())};
+    if (compressed.data.size() < output_size) {
+        compressed.data.resize(output_size);
+    }
 
-    return CompressedData{std::move(output), data.size(), getConfig()};
+    compressed.numBytes = backend_->compress(input, compressed.data);
+    compressed.numElements = data.size();
 }
 
-std::vector<float> TruncCompressor::decompress(const CompressedData& compressedData) {
-    std::vector<float> output(compressedData.numFloats);
-    uLongf output_size{compressedData.numFloats * sizeof(float)};
+template <typename T>
+void TruncCompressor<T>::decompress(const CompressedData& compressedData, std::span<T> output) {
+    if (output.size() < compressedData.numElements) {
+        throw std::invalid_argument("Output buffer too small for decompressed data");
+    }
 
-    int res{::uncompress(reinterpret_cast<Bytef*>(output.data()), &output_size,
-                        compressedData.data.data(), compressedData.data.size())};
+    std::span<const uint8_t> input{compressedData.data.data(), compressedData.numBytes};
+    std::span<uint8_t> values{reinterpret_cast<uint8_t*>(output.data()), compressedData.numElements * sizeof(T)};
 
-    if (res != Z_OK) {
-        throw std::runtime_error("zlib uncompress failed");
+    if (shuffle_ == ShuffleMode::None) {
+        backend_->decompress(input, values);
+        return;
     }
 
-    if (output_size != compressedData.numFloats * sizeof(float)) {
-        throw std::runtime_error("Decompressed size mismatch");
+    if (shuffled_.size() < values.size()) {
+        shuffled_.resize(values.size());
     }
-    
-    return output;
+    std::span<uint8_t> shuffled{shuffled_.data(), values.size()};
+    backend_->decompress(input, shuffled);
+    unshuffle(shuffled, values, sizeof(T), shuffle_);
 }
 
-std::vector<float> TruncCompressor::truncate_mantissas(const std::vector<float>& values, int mantissaBits) {
-    if (mantissaBits < 0 || mantissaBits > 23) {
-        return values; // No truncation needed
+template <typename T>
+void TruncCompressor<T>::truncate_mantissas(std::span<const T> values, std::span<T> result, int mantissaBits) {
+    if constexpr (std::is_floating_point_v<T>) {
+        // Vectorized kernel chosen by CPU feature; see TruncKernels.hpp
+        truncateMantissas(values, result, mantissaBits);
+    } else {
+        std::copy(values.begin(), values.end(), result.begin()); // No mantissa to truncate
     }
+}
 
-    std::vector<float> result;
-    result.reserve(values.size());
-    for (const float& value : values) {
-        union { float f; uint32_t u; } u{value};
-        if (mantissaBits < 23) {
-            uint32_t shift{23 - mantissaBits};
-            uint32_t mask{~((1u << shift) - 1)};
-            uint32_t round_bit{1u << (shift - 1)};
-            // Add rounding bit before masking
-            u.u += round_bit;
-            u.u &= (0xFF800000 | mask); // keep sign, exponent, and top mantissaBits
-        }
-        result.push_back(u.f);
-    }
-    return result;
-}
\ No newline at end of file
+template class TruncCompressor<float>;
+template class TruncCompressor<double>;
+template class TruncCompressor<int32_t>;
+template class TruncCompressor<char>;
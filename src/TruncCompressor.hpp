@@ -1,73 +1,102 @@
 
 /**
  * @file TruncCompressor.hpp
- * @brief TruncCompressor class for lossy float compression using mantissa truncation and zlib.
+ * @brief TruncCompressor class for lossy floating-point compression using mantissa truncation and a lossless backend.
  */
 
 #pragma once
 
+#include <span>
 #include <vector>
 #include <stdexcept>
 #include <cstdint>
 #include <cstring>
-#include <zlib.h>
+#include <memory>
 #include "Compressor.hpp"
+#include "LosslessBackend.hpp"
+#include "Shuffle.hpp"
 
 /**
  * @class TruncCompressor
- * @brief Compressor that truncates mantissa bits of floats and compresses with zlib.
+ * @brief Compressor that truncates mantissa bits of floats and compresses with a lossless backend.
+ *
+ * The backend (zlib, zstd, lz4 or libdeflate) runs at compressionLevel; see LosslessBackend.hpp.
+ * Truncated values can be byte- or bit-shuffled before the backend; see Shuffle.hpp.
+ *
+ * Instantiated for float, double, int32_t and char. Integer and char columns have no
+ * mantissa, so for them mantissaBits is ignored and compression is lossless.
  */
-class TruncCompressor : public Compressor {
+template <typename T>
+class TruncCompressor : public Compressor<T> {
 public:
     /**
      * @brief Construct a TruncCompressor given values.
-     * @param compressionLevel zlib compression level.
+     * @param compressionLevel Compression level of the lossless backend.
      * @param mantissaBits Number of mantissa bits to keep.
+     * @param backend Name of the lossless backend.
+     * @param shuffle Transpose applied between truncation and the backend.
      */
-    TruncCompressor(int compressionLevel, int mantissaBits);
+    TruncCompressor(int compressionLevel, int mantissaBits, const std::string& backend = "zlib",
+                    ShuffleMode shuffle = ShuffleMode::None);
 
     /**
      * @brief Construct a TruncCompressor from configuration map.
      * @param config Map of configuration options.
      * Keys: 
-     *  "compressionLevel" - zlib compression level (int).
-     *  "mantissaBits" - number of mantissa bits to keep (int).
+     *  "compressionLevel" - compression level of the lossless backend (int).
+     *  "mantissaBits" - number of mantissa bits to keep (int, at most 23 for float and 52 for double).
+     *  "backend" - optional lossless backend: zlib (default), zstd, lz4 or libdeflate.
+     *  "shuffle" - optional transpose before the backend: none (default), byte or bit.
      */
     TruncCompressor(const std::map<std::string, std::string>& config);
 
 
-    /** Setters and getters for mantissa bits and compression level. */
+    /** Setters and getters for mantissa bits, compression level, lossless backend and shuffle. */
     void setMantissaBits(int mantissaBits);
     int getMantissaBits() const;
     void setCompressionLevel(int level);
     int getCompressionLevel() const;
+    void setBackend(const std::string& backend);
+    std::string getBackend() const;
+    void setShuffle(ShuffleMode shuffle);
+    ShuffleMode getShuffle() const;
 
     std::string toString() const override;
     std::map<std::string, std::string> getConfig() const override;
+    size_t compressBound(size_t numElements) const override;
 
     /**
      * @brief Compress input data.
      * @param data Uncompressed data to compress.
-     * @return CompressedData containing compressed result.
+     * @param compressed CompressedData receiving the compressed result.
      */
-    CompressedData compress(const std::vector<float>& data) override;
+    void compress(std::span<const T> data, CompressedData& compressed) override;
 
     /**
      * @brief Decompress input data.
      * @param compressedData Compressed data to decompress.
-     * @return Decompressed float vector containing decompressed result.
+     * @param output Buffer of compressedData.numElements elements receiving the decompressed result.
      */
-    std::vector<float> decompress(const CompressedData& compressedData) override;
+    void decompress(const CompressedData& compressedData, std::span<T> output) override;
 
 private:
-    int mantissaBits_ = 8; ///< Number of mantissa bits to keep (0-23 for float)
-    int compressionLevel_ = Z_BEST_COMPRESSION; ///< zlib compression level
+    int mantissaBits_ = 8; ///< Number of mantissa bits to keep (0-23 for float, 0-52 for double)
+    int compressionLevel_ = 9; ///< Compression level of the lossless backend
+    std::unique_ptr<LosslessBackend> backend_;  ///< Lossless stage applied to truncated values
+    ShuffleMode shuffle_ = ShuffleMode::None;   ///< Transpose applied before the backend
+    std::vector<T> truncated_;      ///< Scratch buffer for truncated values, reused across calls
+    std::vector<uint8_t> shuffled_; ///< Scratch buffer for shuffled bytes, reused across calls
 
     /**
-     * @brief Truncate mantissa of floats to mantissaBits bits, with rounding.
-     * @param values Vector of float values.
+     * @brief Replace the lossless backend; validates the level for that backend.
+     */
+    void resetBackend(const std::string& backend, int compressionLevel);
+
+    /**
+     * @brief Truncate mantissa of values to mantissaBits bits, with rounding.
+     * @param values View of values.
+     * @param result Output view receiving the truncated values (same size as values).
      * @param mantissaBits Number of mantissa bits to keep.
-     * @return Vector of truncated float values.
      */
-    static std::vector<float> truncate_mantissas(const std::vector<float>& values, int mantissaBits);
+    static void truncate_mantissas(std::span<const T> values, std::span<T> result, int mantissaBits);
 };
\ No newline at end of file
@@ -0,0 +1,197 @@
+/**
+ * @file TruncKernels.cpp
+ * @brief Scalar, AVX2 and AVX-512 mantissa truncation kernels and their runtime dispatch.
+ *
+ * The SIMD kernels are compiled with per-function target attributes, so the rest of
+ * the build does not need -mavx2 and the binary still runs on CPUs without AVX2.
+ */
+#include "TruncKernels.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TRUNC_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define TRUNC_KERNELS_X86 0
+#endif
+
+namespace {
+
+/** Unsigned integer with the same width as T: uint32_t for float, uint64_t for double. */
+template <typename T>
+using BitsOf = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+/**
+ * @brief Portable kernel; also finishes the tail of the AVX2 kernel.
+ *
+ * Adds the rounding bit to the bit pattern and masks off the dropped bits. Every other
+ * kernel does exactly the same integer add and and, so results are bit-identical.
+ */
+template <typename T>
+void truncateScalar(const T* values, T* result, size_t size, BitsOf<T> roundBit, BitsOf<T> mask) {
+    for (size_t i = 0; i < size; ++i) {
+        BitsOf<T> bits = std::bit_cast<BitsOf<T>>(values[i]);
+        bits += roundBit;
+        bits &= mask;
+        result[i] = std::bit_cast<T>(bits);
+    }
+}
+
+#if TRUNC_KERNELS_X86
+
+template <typename T>
+__attribute__((target("avx2")))
+void truncateAVX2(const T* values, T* result, size_t size, BitsOf<T> roundBit, BitsOf<T> mask) {
+    constexpr size_t lanes = 32 / sizeof(T);
+
+    __m256i round, keep;
+    if constexpr (sizeof(T) == 4) {
+        round = _mm256_set1_epi32(static_cast<int32_t>(roundBit));
+        keep = _mm256_set1_epi32(static_cast<int32_t>(mask));
+    } else {
+        round = _mm256_set1_epi64x(static_cast<int64_t>(roundBit));
+        keep = _mm256_set1_epi64x(static_cast<int64_t>(mask));
+    }
+
+    size_t i = 0;
+    for (; i + lanes <= size; i += lanes) {
+        __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        if constexpr (sizeof(T) == 4) {
+            bits = _mm256_add_epi32(bits, round);
+        } else {
+            bits = _mm256_add_epi64(bits, round);
+        }
+        bits = _mm256_and_si256(bits, keep);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), bits);
+    }
+
+    truncateScalar(values + i, result + i, size - i, roundBit, mask);
+}
+
+template <typename T>
+__attribute__((target("avx512f")))
+void truncateAVX512(const T* values, T* result, size_t size, BitsOf<T> roundBit, BitsOf<T> mask) {
+    constexpr size_t lanes = 64 / sizeof(T);
+
+    __m512i round, keep;
+    if constexpr (sizeof(T) == 4) {
+        round = _mm512_set1_epi32(static_cast<int32_t>(roundBit));
+        keep = _mm512_set1_epi32(static_cast<int32_t>(mask));
+    } else {
+        round = _mm512_set1_epi64(static_cast<int64_t>(roundBit));
+        keep = _mm512_set1_epi64(static_cast<int64_t>(mask));
+    }
+
+    size_t i = 0;
+    for (; i + lanes <= size; i += lanes) {
+        __m512i bits = _mm512_loadu_si512(values + i);
+        if constexpr (sizeof(T) == 4) {
+            bits = _mm512_add_epi32(bits, round);
+        } else {
+            bits = _mm512_add_epi64(bits, round);
+        }
+        _mm512_storeu_si512(result + i, _mm512_and_si512(bits, keep));
+    }
+
+    // Finish with one masked iteration instead of a scalar loop
+    if (i < size) {
+        if constexpr (sizeof(T) == 4) {
+            __mmask16 tail = static_cast<__mmask16>((1u << (size - i)) - 1);
+            __m512i bits = _mm512_add_epi32(_mm512_maskz_loadu_epi32(tail, values + i), round);
+            _mm512_mask_storeu_epi32(result + i, tail, _mm512_and_si512(bits, keep));
+        } else {
+            __mmask8 tail = static_cast<__mmask8>((1u << (size - i)) - 1);
+            __m512i bits = _mm512_add_epi64(_mm512_maskz_loadu_epi64(tail, values + i), round);
+            _mm512_mask_storeu_epi64(result + i, tail, _mm512_and_si512(bits, keep));
+        }
+    }
+}
+
+#endif // TRUNC_KERNELS_X86
+
+template <typename T>
+void truncate(std::span<const T> values, std::span<T> result, int mantissaBits, SimdLevel level) {
+    constexpr int digits = std::numeric_limits<T>::digits - 1;
+
+    if (result.size() < values.size()) {
+        throw std::invalid_argument("Output buffer too small for truncated values");
+    }
+    if (level > detectSimdLevel()) {
+        throw std::invalid_argument("CPU does not support the " + simdLevelName(level) + " truncation kernel");
+    }
+
+    if (mantissaBits < 0 || mantissaBits >= digits) {
+        if (values.data() != result.data()) {
+            std::copy(values.begin(), values.end(), result.begin()); // No truncation needed
+        }
+        return;
+    }
+
+    // Keep sign, exponent, and top mantissaBits; round to nearest by adding half of the dropped range
+    using Bits = BitsOf<T>;
+    const Bits shift = digits - mantissaBits;
+    const Bits mask = ~((Bits{1} << shift) - 1);
+    const Bits roundBit = Bits{1} << (shift - 1);
+
+    switch (level) {
+#if TRUNC_KERNELS_X86
+        case SimdLevel::AVX512:
+            truncateAVX512(values.data(), result.data(), values.size(), roundBit, mask);
+            return;
+        case SimdLevel::AVX2:
+            truncateAVX2(values.data(), result.data(), values.size(), roundBit, mask);
+            return;
+#endif
+        default:
+            truncateScalar(values.data(), result.data(), values.size(), roundBit, mask);
+            return;
+    }
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#if TRUNC_KERNELS_X86
+    // Also checks that the OS saves the wider registers
+    static const SimdLevel level = __builtin_cpu_supports("avx512f") ? SimdLevel::AVX512
+                                 : __builtin_cpu_supports("avx2")    ? SimdLevel::AVX2
+                                                                     : SimdLevel::Scalar;
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+std::string simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar:
+            return "scalar";
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::AVX512:
+            return "avx512";
+    }
+    throw std::invalid_argument("Unknown SIMD level");
+}
+
+void truncateMantissas(std::span<const float> values, std::span<float> result, int mantissaBits) {
+    truncate(values, result, mantissaBits, detectSimdLevel());
+}
+
+void truncateMantissas(std::span<const double> values, std::span<double> result, int mantissaBits) {
+    truncate(values, result, mantissaBits, detectSimdLevel());
+}
+
+void truncateMantissas(std::span<const float> values, std::span<float> result, int mantissaBits, SimdLevel level) {
+    truncate(values, result, mantissaBits, level);
+}
+
+void truncateMantissas(std::span<const double> values, std::span<double> result, int mantissaBits, SimdLevel level) {
+    truncate(values, result, mantissaBits, level);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file TruncKernels.hpp
+ * @brief Vectorized mantissa truncation kernels, selected at runtime by CPU feature.
+ */
+#pragma once
+
+#include <span>
+#include <string>
+
+/**
+ * @brief Instruction set used by a truncation kernel.
+ */
+enum class SimdLevel {
+    Scalar,     ///< Portable loop, available everywhere
+    AVX2,       ///< 256-bit integer add/and
+    AVX512      ///< 512-bit integer add/and (AVX-512F)
+};
+
+/**
+ * @brief Widest instruction set supported by the CPU this process runs on.
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @brief Name of an instruction set ("scalar", "avx2" or "avx512").
+ */
+std::string simdLevelName(SimdLevel level);
+
+/**
+ * @brief Round values to mantissaBits mantissa bits, using the widest kernel the CPU supports.
+ *
+ * All kernels add the rounding bit to the IEEE-754 bit pattern and then mask off the
+ * dropped bits, so they produce bit-identical results. values and result may be the same
+ * buffer, for in-place truncation.
+ *
+ * @param values Input values.
+ * @param result Output view receiving the truncated values (same size as values).
+ * @param mantissaBits Number of mantissa bits to keep, in [0,23] for float and [0,52] for
+ *                     double (values are copied unchanged for 23 or more with float, 52 or
+ *                     more with double).
+ */
+void truncateMantissas(std::span<const float> values, std::span<float> result, int mantissaBits);
+void truncateMantissas(std::span<const double> values, std::span<double> result, int mantissaBits);
+
+/**
+ * @brief Round values to mantissaBits mantissa bits with a given kernel.
+ *
+ * Used to compare kernels against each other; normal callers should let the kernel be
+ * chosen by CPU feature.
+ *
+ * @throws std::invalid_argument if the CPU does not support level.
+ */
+void truncateMantissas(std::span<const float> values, std::span<float> result, int mantissaBits, SimdLevel level);
+void truncateMantissas(std::span<const double> values, std::span<double> result, int mantissaBits, SimdLevel level);
@@ -1,20 +1,68 @@
+#include <algorithm>
+#include <filesystem>
 #include <format>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "AutoTuner.hpp"
 #include "CompressorBenchmark.hpp"
+#include "Container.hpp"
+#include "RootChunkTree.hpp"
+#include "../utils/cache.hpp"
 #include "../utils/utils.hpp"
 #include "../utils/root.hpp"
 #include "../utils/cli.hpp"
 
-void writeJSON(const Args& args, const std::string& branch, const BenchmarkResult& result) {
-    std::cout << timeMessage(std::format("Writing results to {}", args.resultsFile)) << std::endl;
+/**
+ * @brief Summarize the throughputs of repeated trials as JSON.
+ */
+nlohmann::json throughputStatsRecord(const ThroughputStats& stats) {
+    nlohmann::json record;
+    record["median"] = stats.median;
+    record["p5"] = stats.p5;
+    record["p95"] = stats.p95;
+    record["mean"] = stats.mean;
+    record["stddev"] = stats.stddev;
+    record["min"] = stats.min;
+    record["max"] = stats.max;
+    record["trials"] = stats.trials;
+    return record;
+}
+
+/**
+ * @brief Summarize a latency histogram as JSON: count, percentiles, max and non-empty buckets.
+ */
+nlohmann::json latencyRecord(const LatencyHistogram& latency) {
+    nlohmann::json record;
+    record["count"] = latency.count();
+    record["p50"] = latency.percentile(0.5);
+    record["p90"] = latency.percentile(0.9);
+    record["p99"] = latency.percentile(0.99);
+    record["p999"] = latency.percentile(0.999);
+    record["max"] = latency.max();
+    record["buckets"] = nlohmann::json::array();
+    for (size_t bucket = 0; bucket < LatencyHistogram::kNumBuckets; ++bucket) {
+        if (latency.buckets()[bucket] > 0) {
+            record["buckets"].push_back({{"lowerNs", LatencyHistogram::bucketLowerBound(bucket)},
+                                         {"count", latency.buckets()[bucket]}});
+        }
+    }
+    return record;
+}
 
+/**
+ * @brief Build the JSON record of one benchmark run.
+ */
+nlohmann::json makeRecord(const Args& args, const std::string& branch, ElementType elementType, const BenchmarkResult& result) {
     // Create JSON object
     nlohmann::json newRecord;
 
@@ -28,26 +76,100 @@ void writeJSON(const Args& args, const std::string& branch, const BenchmarkResul
     newRecord["args"]["dataFile"] = tokenize(args.dataFile, '/').back();
     newRecord["args"]["treename"] = args.treename;
     newRecord["args"]["branch"] = branch;
+    newRecord["args"]["readThreads"] = args.readThreads;
     newRecord["args"]["chunkSize"] = args.chunkSize;
+    newRecord["args"]["chunking"] = args.chunking;
     newRecord["args"]["compressor"] = args.compressor;
     newRecord["args"]["compressionOptions"] = args.compressionOptions;
+    newRecord["args"]["threads"] = args.numThreads;
+    newRecord["args"]["stream"] = args.stream;
+    newRecord["args"]["pipeline"] = args.pipeline;
+    newRecord["args"]["warmupRuns"] = args.warmupRuns;
+    newRecord["args"]["trials"] = args.trials;
+    newRecord["args"]["clock"] = args.clock;
+    newRecord["args"]["perfCounters"] = args.perfCounters;
+    newRecord["args"]["chunkRecords"] = args.chunkRecordsFile;
+    newRecord["args"]["container"] = args.containerFile;
+    newRecord["args"]["readBenchmark"] = args.readBenchmarkDir;
+    newRecord["args"]["sweep"] = !args.sweep.empty();
     newRecord["args"]["writeDecompressed"] = args.writeDecompressed;
     newRecord["args"]["decompFile"] = args.decompFile;
 
     // Save benchmark results
+    newRecord["results"]["elementType"] = elementTypeName(elementType);
     newRecord["results"]["compressionThroughputMBps"] = result.compressionThroughputMBps;
     newRecord["results"]["decompressionThroughputMBps"] = result.decompressionThroughputMBps;
+    newRecord["results"]["threadCompressionThroughputMBps"] = result.threadCompressionThroughputMBps;
+    newRecord["results"]["threadDecompressionThroughputMBps"] = result.threadDecompressionThroughputMBps;
     newRecord["results"]["compressionRatio"] = result.compressionRatio;
+    newRecord["results"]["numChunks"] = result.numChunks;
+    newRecord["results"]["numThreads"] = result.numThreads;
     newRecord["results"]["MSE"] = result.MSE; 
     newRecord["results"]["PSNR"] = result.PSNR;
     newRecord["results"]["meanRelError"] = result.meanRelError;
     newRecord["results"]["maxRelError"] = result.maxRelError;
     newRecord["results"]["meanAbsError"] = result.meanAbsError;
     newRecord["results"]["maxAbsError"] = result.maxAbsError;
+    newRecord["results"]["KLdivergence"] = result.KLdivergence;
+    newRecord["results"]["JSdivergence"] = result.JSdivergence;
+    newRecord["results"]["WassersteinDistance"] = result.WassersteinDistance;
+    newRecord["results"]["KSstatistic"] = result.KSstatistic;
+    newRecord["results"]["exactDistributions"] = result.exactDistributions;
+
+    newRecord["results"]["clock"] = result.clock;
+    for (const auto& [name, stats] : {std::pair{"compressionThroughputStats", &result.compressionStats},
+                                      std::pair{"decompressionThroughputStats", &result.decompressionStats}}) {
+        if (stats->trials.empty()) {
+            continue;
+        }
+        newRecord["results"][name] = throughputStatsRecord(*stats);
+    }
+
+    for (const auto& [name, latency] : {std::pair{"compressionLatencyNs", &result.compressionLatency},
+                                        std::pair{"decompressionLatencyNs", &result.decompressionLatency}}) {
+        if (latency->count() > 0) {
+            newRecord["results"][name] = latencyRecord(*latency);
+        }
+    }
+
+    if (args.perfCounters) {
+        for (const auto& [name, perf] : {std::pair{"compress", &result.compressionPerf},
+                                         std::pair{"decompress", &result.decompressionPerf}}) {
+            nlohmann::json& record = newRecord["results"]["perf"][name];
+            record["available"] = perf->any();
+            if (!perf->any()) {
+                continue;
+            }
+            record["bytes"] = perf->numBytes;
+            for (size_t i = 0; i < kNumPerfEvents; ++i) {
+                PerfEvent event = static_cast<PerfEvent>(i);
+                record[perfEventName(event)] = perf->has(event) ? nlohmann::json(perf->values[i]) : nlohmann::json(nullptr);
+            }
+            record["cyclesPerByte"] = perf->cyclesPerByte();
+            record["IPC"] = perf->has(PerfEvent::Instructions) ? nlohmann::json(perf->IPC()) : nlohmann::json(nullptr);
+        }
+    }
+
+    if (!result.stageTimings.empty()) {
+        newRecord["results"]["wallTimeMs"] = result.wallTimeMs;
+        for (const StageTiming& timing : result.stageTimings) {
+            newRecord["results"]["stages"][timing.stage]["busyMs"] = timing.busyMs;
+            newRecord["results"]["stages"][timing.stage]["idleMs"] = timing.idleMs;
+        }
+    }
+
+    return newRecord;
+}
+
+/**
+ * @brief Append records to the JSON array in resultsFile, creating it if needed.
+ */
+void appendRecords(const std::string& resultsFile, const std::vector<nlohmann::json>& records) {
+    std::cout << timeMessage(std::format("Writing {} result(s) to {}", records.size(), resultsFile)) << std::endl;
 
     // Load existing records
     nlohmann::json allRecords;
-    std::ifstream inFile(args.resultsFile);
+    std::ifstream inFile(resultsFile);
     if (inFile) {
         inFile >> allRecords;
         if (!allRecords.is_array()) {
@@ -58,45 +180,618 @@ void writeJSON(const Args& args, const std::string& branch, const BenchmarkResul
     }
     inFile.close();
 
-    // Append new record
-    allRecords.push_back(newRecord);
+    // Append new records
+    for (const nlohmann::json& record : records) {
+        allRecords.push_back(record);
+    }
 
     // Write all records back to file
-    std::ofstream outFile(args.resultsFile);
+    std::ofstream outFile(resultsFile);
     outFile << std::setw(4) << allRecords << std::endl;
     outFile.close();
 }
 
+/**
+ * @brief Append the chunk records of one result to a CSV file, writing the header if the file is new.
+ *
+ * Options are written as one quoted key=value;key=value field, so rows of different
+ * configurations share the same columns.
+ */
+void appendChunkRecords(const std::string& chunkRecordsFile, const std::string& branch, const std::string& compressor,
+                        const std::map<std::string, std::string>& options, const BenchmarkResult& result)
+{
+    bool newFile = !std::filesystem::exists(chunkRecordsFile);
+    std::ofstream outFile(chunkRecordsFile, std::ios::app);
+    if (!outFile) {
+        throw std::runtime_error("Cannot open chunk records file: " + chunkRecordsFile);
+    }
+    if (newFile) {
+        outFile << "branch,compressor,options,chunk,inputBytes,compressedBytes,compressNs,decompressNs,maxAbsError\n";
+    }
+
+    std::string optionsField;
+    for (const auto& [key, value] : options) {
+        optionsField += (optionsField.empty() ? "" : ";") + key + "=" + value;
+    }
+
+    for (const ChunkRecord& record : result.chunkRecords) {
+        outFile << std::format("{},{},\"{}\",{},{},{},{},{},{:.9g}\n", branch, compressor, optionsField,
+                               record.chunkIndex, record.inputBytes, record.compressedBytes,
+                               record.compressNs, record.decompressNs, record.maxAbsError);
+    }
+}
+
+/**
+ * @brief Compute chunk boundaries for a column according to the --chunking policy.
+ * @return Value offsets where chunks start, or an empty vector for fixed-size chunks.
+ */
+template <typename T>
+std::vector<size_t> makeChunkBoundaries(const Args& args, const std::string& branch, const JaggedColumnView<T>& column) {
+    if (args.chunking == "entry") {
+        return entryAlignedChunkBoundaries(column.offsets, std::max<size_t>(args.chunkSize / sizeof(T), 1));
+    } else if (args.chunking == "basket") {
+        return entryRangeChunkBoundaries(column.offsets, readBasketBoundaries(args.dataFile, args.treename, branch));
+    } else if (args.chunking == "cluster") {
+        return entryRangeChunkBoundaries(column.offsets, readClusterBoundaries(args.dataFile, args.treename));
+    }
+    return {};
+}
+
+/**
+ * @brief Chunk boundaries for writing a column's compressed chunks out: those of the
+ *        --chunking policy, or explicit fixed-size ones.
+ */
+template <typename T>
+std::vector<size_t> makeWriteChunkBoundaries(const Args& args, const std::string& branch, const JaggedColumnView<T>& column) {
+    std::vector<size_t> boundaries = makeChunkBoundaries(args, branch, column);
+    if (boundaries.empty()) {
+        boundaries = fixedChunkBoundaries(column.values.size(), std::max<size_t>(args.chunkSize / sizeof(T), 1));
+    }
+    return boundaries;
+}
+
+/**
+ * @brief Apply the threading and timing options of args to a benchmark.
+ */
+template <typename T>
+void configureBenchmark(const Args& args, CompressorBenchmark<T>& benchmark) {
+    benchmark.setNumThreads(args.numThreads);
+    benchmark.setWarmupRuns(args.warmupRuns);
+    benchmark.setTrials(args.trials);
+    benchmark.setTimingClock(parseTimingClock(args.clock));
+    benchmark.setPerfCounters(args.perfCounters);
+    benchmark.setChunkRecords(!args.chunkRecordsFile.empty());
+    benchmark.setExactDistributions(args.exactDistributions);
+}
+
+/**
+ * @brief Benchmark one branch whose elements are of type T.
+ * @param column In-memory column of the branch, or nullptr in the stream and pipeline modes.
+ * @param decompressed Optional buffer of column->values.size() elements receiving the
+ *                     decompressed values (in-memory mode only).
+ */
+template <typename T>
+BenchmarkResult runBranchBenchmark(const Args& args, const std::string& branch, const JaggedColumnView<T>* column,
+                                   std::span<T> decompressed = {})
+{
+    // Create benchmark
+    CompressorBenchmark<T> benchmark(args.chunkSize, args.compressor, args.compressionOptions);
+    configureBenchmark(args, benchmark);
+
+    if (args.pipeline) {
+        // Overlap ROOT reading with compression, decompression and metrics
+        BranchChunkReader<T> reader(args.dataFile, args.treename, branch, args.chunkSize,
+                                    std::numeric_limits<size_t>::max(), args.chunking == "entry");
+        return benchmark.runPipeline([&reader](std::vector<T>& chunk) {
+            return reader.next(chunk);
+        });
+    } else if (args.stream) {
+        // Stream chunks straight from the tree, never holding the whole branch
+        BranchChunkReader<T> reader(args.dataFile, args.treename, branch, args.chunkSize,
+                                    std::numeric_limits<size_t>::max(), args.chunking == "entry");
+        return benchmark.runStream([&reader](std::vector<T>& chunk) {
+            return reader.next(chunk);
+        });
+    }
+
+    // Run benchmark directly on the column's values
+    benchmark.setChunkBoundaries(makeChunkBoundaries(args, branch, *column));
+    return benchmark.run(column->values, decompressed);
+}
+
+/**
+ * @brief Compress one in-memory column and append its chunks to a container.
+ *
+ * The chunks are compressed again with the benchmark's compressor and chunk boundaries,
+ * outside the timed benchmark. The container is created on the first branch, with that
+ * branch's compressor config.
+ */
+template <typename T>
+void writeContainerBranch(const Args& args, const std::string& branch, const JaggedColumnView<T>& column,
+                          std::unique_ptr<ContainerWriter>& container)
+{
+    std::shared_ptr<Compressor<T>> compressor = makeCompressor<T>(args.compressor, args.compressionOptions);
+    if (!container) {
+        container = std::make_unique<ContainerWriter>(args.containerFile, args.compressor, compressor->getConfig());
+    }
+
+    std::vector<size_t> boundaries = makeWriteChunkBoundaries(args, branch, column);
+    container->beginBranch(branch, elementTypeOf<T>());
+    CompressedData compressed;
+    for (size_t chunkInx = 0; chunkInx + 1 < boundaries.size(); ++chunkInx) {
+        std::span<const T> chunk = column.values.subspan(boundaries[chunkInx], boundaries[chunkInx + 1] - boundaries[chunkInx]);
+        compressor->compress(chunk, compressed);
+        container->writeChunk(compressed);
+    }
+    container->endBranch(column.offsets);
+}
+
+/**
+ * @brief Time decompressing random entry ranges of one container branch.
+ *
+ * Ranges of args.rangeEntries entries start at uniformly random entries (fixed seed, so
+ * runs are comparable). Only the chunks overlapping each range are decompressed.
+ *
+ * @return JSON summary: chunk and byte counts of the branch and the latency of each range.
+ */
+nlohmann::json measureRandomAccess(const Args& args, const ContainerReader& reader, const ContainerBranch& branch) {
+    nlohmann::json record;
+    uint64_t compressedBytes = 0;
+    for (const ContainerChunk& chunk : branch.chunks) {
+        compressedBytes += chunk.numBytes;
+    }
+    record["file"] = args.containerFile;
+    record["numChunks"] = branch.chunks.size();
+    record["compressedBytes"] = compressedBytes;
+    record["offsetsBytes"] = (branch.numEntries + 1) * sizeof(uint64_t);
+    if (args.randomAccessRanges == 0 || branch.numEntries == 0) {
+        return record;
+    }
+
+    uint64_t rangeEntries = std::min<uint64_t>(args.rangeEntries, branch.numEntries);
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint64_t> firstEntries(0, branch.numEntries - rangeEntries);
+
+    LatencyHistogram latency;
+    size_t totalChunks = 0;
+    visitElementType(branch.elementType, [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        std::shared_ptr<Compressor<T>> decompressor = makeCompressor<T>(reader.getCompressorName(), reader.getConfig());
+        for (int i = 0; i < args.randomAccessRanges; ++i) {
+            uint64_t firstEntry = firstEntries(rng);
+            size_t chunksRead = 0;
+            double start = clockMs(TimingClock::Wall);
+            JaggedColumn<T> entries = reader.readEntries<T>(branch.name, firstEntry, firstEntry + rangeEntries, *decompressor, &chunksRead);
+            double end = clockMs(TimingClock::Wall);
+            latency.record(static_cast<uint64_t>(std::llround((end - start) * 1e6)));
+            totalChunks += chunksRead;
+        }
+    });
+
+    std::cout << timeMessage(std::format("Read {} random ranges of {} entries from '{}': p50 {:.1f} us, p99 {:.1f} us, {:.2f} chunks per range",
+                                         args.randomAccessRanges, rangeEntries, branch.name, latency.percentile(0.5) * 1e-3,
+                                         latency.percentile(0.99) * 1e-3, static_cast<double>(totalChunks) / args.randomAccessRanges)) << std::endl;
+
+    record["randomAccess"]["ranges"] = args.randomAccessRanges;
+    record["randomAccess"]["entriesPerRange"] = rangeEntries;
+    record["randomAccess"]["chunksPerRange"] = static_cast<double>(totalChunks) / args.randomAccessRanges;
+    record["randomAccess"]["latencyNs"] = latencyRecord(latency);
+    return record;
+}
+
+/**
+ * @brief Time reading a ROOT file back into memory, from TFile open until the values are available.
+ *
+ * Runs args.warmupRuns untimed reads, then args.trials timed ones.
+ *
+ * @param read Reads the file and returns the number of values read.
+ * @return Read throughput of each trial, in MB of values per second.
+ */
+ThroughputStats timeFileReads(const Args& args, size_t valueBytes, const std::function<size_t()>& read) {
+    for (int i = 0; i < args.warmupRuns; ++i) {
+        read();
+    }
+    std::vector<double> throughputs;
+    for (int i = 0; i < args.trials; ++i) {
+        double start = clockMs(TimingClock::Wall);
+        read();
+        double end = clockMs(TimingClock::Wall);
+        throughputs.push_back(valueBytes / ((end - start) * 1e-3) / (1024 * 1024));
+    }
+    return summarizeThroughputs(throughputs);
+}
+
+/**
+ * @brief Compare reading one branch from a ROOT file of compressed chunks with reading it
+ *        from ROOT files written with each of args.rootCodecs.
+ *
+ * The chunks are compressed with the benchmark's compressor and chunk boundaries and
+ * stored as entries of a tree (see writeChunkTree()); the native files hold the branch as
+ * a std::vector branch compressed by ROOT. Every file is written to args.readBenchmarkDir
+ * and read back whole, so both formats are timed with a hot page cache.
+ *
+ * @return JSON with file size, compression ratio and read throughput of every file.
+ */
+template <typename T>
+nlohmann::json runReadBenchmark(const Args& args, const std::string& branch, const JaggedColumnView<T>& column) {
+    std::filesystem::create_directories(args.readBenchmarkDir);
+    std::string name = branch;
+    std::replace_if(name.begin(), name.end(), [](char c) { return c == '/' || c == '\\' || c == ':'; }, '_');
+    size_t valueBytes = column.values.size() * sizeof(T);
+
+    auto fileRecord = [&](const std::string& filename, const ThroughputStats& stats) {
+        nlohmann::json record;
+        size_t fileBytes = std::filesystem::file_size(filename);
+        record["file"] = filename;
+        record["fileBytes"] = fileBytes;
+        record["compressionRatio"] = static_cast<double>(valueBytes) / fileBytes;
+        record["readThroughputMBps"] = stats.median;
+        record["readThroughputStats"] = throughputStatsRecord(stats);
+        return record;
+    };
+
+    nlohmann::json record;
+    record["valueBytes"] = valueBytes;
+
+    std::string chunkFile = (std::filesystem::path(args.readBenchmarkDir) / (name + "-rootless.root")).string();
+    writeChunkTree(chunkFile, args.treename, branch, column, makeWriteChunkBoundaries(args, branch, column),
+                   args.compressor, args.compressionOptions);
+    ThroughputStats chunkStats = timeFileReads(args, valueBytes, [&]() {
+        return readChunkTree<T>(chunkFile, args.treename, branch).values.size();
+    });
+    record["rootless"] = fileRecord(chunkFile, chunkStats);
+    record["rootless"]["compressor"] = args.compressor;
+    std::cout << timeMessage(std::format("Read {} from compressed chunks at {:.1f} MB/s ({})",
+                                         branch, chunkStats.median, getSizeString(std::filesystem::file_size(chunkFile)))) << std::endl;
+
+    record["native"] = nlohmann::json::array();
+    for (const auto& [algorithm, level] : args.rootCodecs) {
+        int settings = rootCompressionSettings(algorithm, level);
+        std::string nativeFile = (std::filesystem::path(args.readBenchmarkDir) / std::format("{}-{}{}.root", name, algorithm, level)).string();
+        writeVectorBranches(nativeFile, args.treename, {{branch, AnyColumnView(column)}}, settings);
+        ThroughputStats nativeStats = timeFileReads(args, valueBytes, [&]() {
+            return std::visit([](const auto& typed) { return typed.values.size(); },
+                              readVectorBranches(nativeFile, args.treename, {branch}).at(branch));
+        });
+        nlohmann::json nativeRecord = fileRecord(nativeFile, nativeStats);
+        nativeRecord["algorithm"] = algorithm;
+        nativeRecord["level"] = level;
+        nativeRecord["compressionSettings"] = settings;
+        record["native"].push_back(std::move(nativeRecord));
+        std::cout << timeMessage(std::format("Read {} from ROOT {}:{} at {:.1f} MB/s ({})",
+                                             branch, algorithm, level, nativeStats.median, getSizeString(std::filesystem::file_size(nativeFile)))) << std::endl;
+    }
+    return record;
+}
+
+/**
+ * @brief Run every sweep configuration on one in-memory column.
+ *
+ * The column, its chunk boundaries and one decompressed scratch buffer are shared by all
+ * configurations. Configurations are timed one at a time, so their throughputs are as
+ * comparable as those of separate runs; args.sweepThreads threads accumulate each
+ * configuration's error metrics after its trials.
+ *
+ * @param configs Compressor options of each configuration (see expandSweep()).
+ * @return Results in the order of configs.
+ */
+template <typename T>
+std::vector<BenchmarkResult> runSweep(const Args& args, const std::string& branch, const JaggedColumnView<T>& column,
+                                      const std::vector<std::map<std::string, std::string>>& configs)
+{
+    std::vector<size_t> boundaries = makeChunkBoundaries(args, branch, column);
+    std::vector<BenchmarkResult> results(configs.size());
+    std::vector<T> decompressed(column.values.size());
+
+    for (size_t i = 0; i < configs.size(); ++i) {
+        CompressorBenchmark<T> benchmark(args.chunkSize, args.compressor, configs[i]);
+        configureBenchmark(args, benchmark);
+        benchmark.setChunkBoundaries(boundaries);
+        benchmark.setErrorThreads(args.sweepThreads);
+        results[i] = benchmark.run(column.values, decompressed);
+    }
+    return results;
+}
+
+/**
+ * @brief Tune the --tune option of every sweep configuration on one in-memory column.
+ *
+ * Each configuration is searched on the sampled chunks and confirmed on the full column
+ * (see AutoTuner), and the confirmed winners are then flagged with their Pareto front.
+ * As in runSweep(), configurations are tuned one at a time, so the throughputs the front
+ * is ranked on are not measured on a shared machine; args.sweepThreads threads accumulate
+ * the error metrics of every run.
+ *
+ * @param configs Compressor options of each configuration (see expandSweep()).
+ * @return Winners in the order of configs.
+ */
+template <typename T>
+std::vector<TuneCandidate> runTune(const Args& args, const std::string& branch, const JaggedColumnView<T>& column,
+                                   const std::vector<std::map<std::string, std::string>>& configs,
+                                   const TuneRange& range)
+{
+    AutoTuner<T> tuner(args.chunkSize, args.compressor, range, args.maxAbsError);
+    tuner.setNumThreads(args.numThreads);
+    tuner.setErrorThreads(args.sweepThreads);
+    tuner.setWarmupRuns(args.warmupRuns);
+    tuner.setTrials(args.trials);
+    tuner.setTimingClock(parseTimingClock(args.clock));
+    tuner.setPerfCounters(args.perfCounters);
+    tuner.setSampleFraction(args.tuneSample);
+    tuner.setChunkBoundaries(makeChunkBoundaries(args, branch, column));
+    tuner.setData(column.values);
+
+    std::vector<TuneCandidate> candidates;
+    candidates.reserve(configs.size());
+    for (const std::map<std::string, std::string>& config : configs) {
+        candidates.push_back(tuner.tune(config));
+    }
+
+    markParetoFront(candidates);
+    return candidates;
+}
+
+/**
+ * @brief Build the JSON record of a tuned configuration: its full-data results plus the search.
+ */
+nlohmann::json makeTuneRecord(const Args& args, const std::string& branch, ElementType elementType,
+                              const TuneRange& range, const TuneCandidate& candidate)
+{
+    Args configArgs = args;
+    configArgs.compressionOptions = candidate.options;
+    nlohmann::json record = makeRecord(configArgs, branch, elementType, candidate.result);
+
+    record["tuning"]["option"] = range.option;
+    record["tuning"]["min"] = range.min;
+    record["tuning"]["max"] = range.max;
+    record["tuning"]["value"] = candidate.value;
+    record["tuning"]["maxAbsErrorBound"] = args.maxAbsError;
+    record["tuning"]["sampleFraction"] = args.tuneSample;
+    record["tuning"]["feasible"] = candidate.feasible;
+    record["tuning"]["pareto"] = candidate.pareto;
+    record["tuning"]["sampleEvaluations"] = candidate.sampleEvaluations;
+    record["tuning"]["fullEvaluations"] = candidate.fullEvaluations;
+    record["tuning"]["sample"]["compressionRatio"] = candidate.sampleResult.compressionRatio;
+    record["tuning"]["sample"]["compressionThroughputMBps"] = candidate.sampleResult.compressionThroughputMBps;
+    record["tuning"]["sample"]["maxAbsError"] = candidate.sampleResult.maxAbsError;
+    return record;
+}
+
+/**
+ * @brief In-memory columns of the requested branches, read from the tree or mapped from the column cache.
+ */
+struct BranchColumns {
+    std::map<std::string, AnyColumn> read;                          ///< Columns read from the tree
+    std::map<std::string, std::unique_ptr<MappedColumn>> mapped;    ///< Columns mapped from the cache
+    size_t numEntries{};                                            ///< Entries every branch is cut to
+
+    /** View of the first numEntries entries of a branch's column, wherever it is stored. */
+    AnyColumnView view(const std::string& branch) const {
+        auto it = mapped.find(branch);
+        AnyColumnView column = (it != mapped.end()) ? it->second->view() : viewOf(read.at(branch));
+        return std::visit([this](const auto& typed) -> AnyColumnView {
+            return typed.first(numEntries);
+        }, column);
+    }
+
+    /** Release a branch's column once its benchmark is done. */
+    void release(const std::string& branch) {
+        read.erase(branch);
+        mapped.erase(branch);
+    }
+};
+
+/**
+ * @brief Load every requested branch for the in-memory modes.
+ *
+ * Without --cacheDir, the branches are read from the tree in one pass. With it, branches
+ * with a valid cache file are mapped from it, and the others are read one at a time and
+ * written to the cache for the next run. A cached column then only depends on its own
+ * byte limit, not on the branches it was read with. In both cases every branch is cut to
+ * the entry where reading them together stops, so columns always cover the same entries.
+ */
+BranchColumns loadBranchColumns(const Args& args) {
+    // Both readers stop at the same entry, within 1 GiB per branch
+    size_t maxBytes = size_t{1024} * 1024 * 1024;
+    auto readBranches = [&](const std::vector<std::string>& branches) {
+        if (args.readThreads >= 0) {
+            return readVectorBranchesMT(args.dataFile, args.treename, branches, args.readThreads, maxBytes);
+        }
+        return readVectorBranches(args.dataFile, args.treename, branches, maxBytes);
+    };
+    auto keyOf = [&](const std::string& branch) {
+        ColumnCacheKey key{args.dataFile, args.treename, branch};
+        key.maxBytes = maxBytes;
+        return key;
+    };
+
+    BranchColumns columns;
+    std::vector<std::string> toRead;
+    for (const std::string& branch : args.branches) {
+        std::unique_ptr<MappedColumn> mapped = args.cacheDir.empty() ? nullptr : MappedColumn::open(args.cacheDir, keyOf(branch));
+        if (mapped) {
+            columns.mapped[branch] = std::move(mapped);
+        } else {
+            toRead.push_back(branch);
+        }
+    }
+
+    if (args.cacheDir.empty()) {
+        columns.read = readBranches(toRead);
+    } else {
+        // Read alone, each branch stops at its own limit rather than at a sibling's
+        for (const std::string& branch : toRead) {
+            columns.read[branch] = std::move(readBranches({branch}).at(branch));
+            writeColumnCache(args.cacheDir, keyOf(branch), columns.read.at(branch));
+        }
+    }
+
+    // Reading all branches together stops at the first entry where any of them reaches its limit
+    columns.numEntries = std::numeric_limits<size_t>::max();
+    for (const std::string& branch : args.branches) {
+        auto it = columns.mapped.find(branch);
+        AnyColumnView column = (it != columns.mapped.end()) ? it->second->view() : viewOf(columns.read.at(branch));
+        columns.numEntries = std::min(columns.numEntries, std::visit([](const auto& typed) {
+            return typed.numEntries();
+        }, column));
+    }
+    if (!args.cacheDir.empty() && args.branches.size() > 1) {
+        std::cout << timeMessage(std::format("Using the first {} entries of every branch", columns.numEntries)) << std::endl;
+    }
+    return columns;
+}
+
 int main(int argc, char* argv[]) {
     Args args = parseArgs(argc, argv);
     // printArgs(args);
 
+    // In-memory modes read every requested branch in one pass over the tree, or map it from the cache
+    BranchColumns branchData;
+    if (!args.stream && !args.pipeline) {
+        branchData = loadBranchColumns(args);
+    }
+
+    // Every sweep configuration, or only the --compressor options without a sweep
+    std::vector<std::map<std::string, std::string>> configs = expandSweep(args.compressionOptions, args.sweep);
+    if (!args.sweep.empty()) {
+        std::cout << timeMessage(std::format("Sweeping {} configurations", configs.size())) << std::endl;
+    }
+
+    // Decompressed columns kept for --writeDecompressed, written together after the last branch
+    std::map<std::string, AnyColumn> decompressedData;
+
+    // With --container, chunks of every branch go to one container, and records wait for its random-access results
+    std::unique_ptr<ContainerWriter> container;
+    std::vector<std::pair<std::string, nlohmann::json>> containerRecords;
+
     // Iterate over args.branches
     for (const std::string& branch : args.branches) {
-        // Read data from input file
-        std::vector<std::vector<float>> rawData = readVectorFloatBranch(args.dataFile, args.treename, branch);
+        if (!args.tune.empty()) {
+            // Tune every configuration on the column read above
+            TuneRange range = parseTuneRange(args.tune);
+            if (args.sweep.contains(range.option)) {
+                throw std::invalid_argument("Cannot both sweep and tune " + range.option);
+            }
+
+            AnyColumnView column = branchData.view(branch);
+            ElementType elementType = elementTypeOf(column);
+            std::vector<TuneCandidate> candidates = std::visit([&](const auto& typed) {
+                return runTune(args, branch, typed, configs, range);
+            }, column);
+            branchData.release(branch);
 
-        // Flatten data
-        std::vector<float> flattenedData;
-        for (const auto& vec : rawData) {
-            flattenedData.insert(flattenedData.end(), vec.begin(), vec.end());
+            std::cout << timeMessage(std::format("Pareto front for {} (ratio, compression MB/s, maxAbsError):", branch)) << std::endl;
+            std::vector<nlohmann::json> records;
+            for (const TuneCandidate& candidate : candidates) {
+                if (candidate.pareto) {
+                    std::cout << std::format("\t{:<40} {:>8.3f} {:>10.1f} {:>12.6g}", nlohmann::json(candidate.options).dump(),
+                                             candidate.result.compressionRatio, candidate.result.compressionThroughputMBps,
+                                             candidate.result.maxAbsError) << std::endl;
+                }
+                records.push_back(makeTuneRecord(args, branch, elementType, range, candidate));
+            }
+            appendRecords(args.resultsFile, records);
+            std::cout << std::endl;
+            continue;
         }
 
-        // Create benchmark
-        CompressorBenchmark benchmark(args.chunkSize, args.compressor, args.compressionOptions);
+        if (!args.sweep.empty()) {
+            // Run all configurations on the column read above
+            AnyColumnView column = branchData.view(branch);
+            ElementType elementType = elementTypeOf(column);
+            std::vector<BenchmarkResult> results = std::visit([&](const auto& typed) {
+                return runSweep(args, branch, typed, configs);
+            }, column);
+            branchData.release(branch);
+
+            std::vector<nlohmann::json> records;
+            Args configArgs = args;
+            for (size_t i = 0; i < configs.size(); ++i) {
+                configArgs.compressionOptions = configs[i];
+                records.push_back(makeRecord(configArgs, branch, elementType, results[i]));
+                if (!args.chunkRecordsFile.empty()) {
+                    appendChunkRecords(args.chunkRecordsFile, branch, args.compressor, configs[i], results[i]);
+                }
+            }
+            appendRecords(args.resultsFile, records);
+            std::cout << std::endl;
+            continue;
+        }
 
-        // Run benchmark
-        BenchmarkResult result = benchmark.run(flattenedData);
+        // Dispatch on the branch's element type, so each type runs its own instantiation
+        ElementType elementType;
+        BenchmarkResult result;
+        nlohmann::json readRecord;
+        if (args.stream || args.pipeline) {
+            elementType = readBranchElementType(args.dataFile, args.treename, branch);
+            result = visitElementType(elementType, [&](auto tag) {
+                return runBranchBenchmark<typename decltype(tag)::type>(args, branch, nullptr);
+            });
+        } else {
+            // Release the column once its benchmark is done
+            AnyColumnView column = branchData.view(branch);
+            elementType = elementTypeOf(column);
+            result = std::visit([&](const auto& typed) {
+                if (!args.writeDecompressed) {
+                    return runBranchBenchmark(args, branch, &typed);
+                }
+
+                // Decompress into a column sharing the original's entry offsets
+                using T = typename std::decay_t<decltype(typed)>::value_type;
+                JaggedColumn<T> decompressedColumn;
+                decompressedColumn.values.resize(typed.values.size());
+                decompressedColumn.offsets.assign(typed.offsets.begin(), typed.offsets.end());
+                BenchmarkResult branchResult = runBranchBenchmark(args, branch, &typed, std::span<T>(decompressedColumn.values));
+                decompressedData[branch] = std::move(decompressedColumn);
+                return branchResult;
+            }, column);
+            if (!args.containerFile.empty()) {
+                std::visit([&](const auto& typed) {
+                    writeContainerBranch(args, branch, typed, container);
+                }, column);
+            }
+            if (!args.readBenchmarkDir.empty()) {
+                readRecord = std::visit([&](const auto& typed) {
+                    return runReadBenchmark(args, branch, typed);
+                }, column);
+            }
+            branchData.release(branch);
+        }
 
         // Write results to JSON
-        writeJSON(args, branch, result);
+        nlohmann::json record = makeRecord(args, branch, elementType, result);
+        if (!readRecord.is_null()) {
+            record["results"]["readBenchmark"] = std::move(readRecord);
+        }
+        if (!args.containerFile.empty()) {
+            containerRecords.emplace_back(branch, std::move(record));
+        } else {
+            appendRecords(args.resultsFile, {record});
+        }
+        if (!args.chunkRecordsFile.empty()) {
+            appendChunkRecords(args.chunkRecordsFile, branch, args.compressor, args.compressionOptions, result);
+        }
         std::cout << std::endl;
+    }
+
+    // Close the container, then read random entry ranges back from it
+    if (container) {
+        container->close();
+        std::cout << timeMessage(std::format("Wrote {} to container '{}'", getSizeString(container->bytesWritten()), args.containerFile)) << std::endl;
 
-        // Optionally write decompressed data to file
-        if (args.writeDecompressed) {
-            // writeDecompressedDataToRootFile(args, branch, result);
+        ContainerReader reader(args.containerFile);
+        std::vector<nlohmann::json> records;
+        for (auto& [branch, record] : containerRecords) {
+            record["results"]["container"] = measureRandomAccess(args, reader, reader.getBranch(branch));
+            records.push_back(std::move(record));
         }
+        appendRecords(args.resultsFile, records);
+    }
+
+    // Optionally write all decompressed branches to one tree
+    if (args.writeDecompressed) {
+        writeDecompressedDataToRootFile(args.decompFile, args.treename, decompressedData);
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/TruncKernels.hpp"
+
+/**
+ * Micro-benchmark of the mantissa truncation kernels.
+ *
+ * For every mantissaBits setting, runs each kernel the CPU supports over a buffer much
+ * larger than the caches, checks that its output is bit-identical to the scalar kernel,
+ * and prints the best throughput over several repetitions in GB/s of input.
+ *
+ * Usage: benchmark-TruncKernels [numValues] [repetitions]
+ */
+template <typename T>
+bool benchmarkKernels(const std::string& typeName, size_t numValues, int repetitions) {
+    constexpr int digits = std::numeric_limits<T>::digits - 1;
+    using Clock = std::chrono::high_resolution_clock;
+
+    // Generate random dummy data; an odd size exercises the kernels' tails
+    std::mt19937 gen(42); // Fixed seed for reproducibility
+    std::normal_distribution<T> dis(50.0, 10.0);
+    std::vector<T> data(numValues | 1);
+    for (auto& val : data) {
+        val = dis(gen);
+    }
+
+    std::vector<T> expected(data.size());
+    std::vector<T> result(data.size());
+
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+    for (SimdLevel level : {SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= detectSimdLevel()) {
+            levels.push_back(level);
+        }
+    }
+
+    std::cout << std::format("{:<8} {:>12}", typeName, "mantissaBits");
+    for (SimdLevel level : levels) {
+        std::cout << std::format(" {:>12}", simdLevelName(level) + " GB/s");
+    }
+    std::cout << "\n";
+
+    bool identical = true;
+    for (int mantissaBits = 0; mantissaBits <= digits; ++mantissaBits) {
+        truncateMantissas(data, expected, mantissaBits, SimdLevel::Scalar);
+
+        std::cout << std::format("{:<8} {:>12}", "", mantissaBits);
+        for (SimdLevel level : levels) {
+            double bestSeconds = std::numeric_limits<double>::max();
+            for (int rep = 0; rep < repetitions; ++rep) {
+                auto start = Clock::now();
+                truncateMantissas(data, result, mantissaBits, level);
+                auto end = Clock::now();
+                bestSeconds = std::min(bestSeconds, std::chrono::duration<double>(end - start).count());
+            }
+
+            if (std::memcmp(result.data(), expected.data(), data.size() * sizeof(T)) != 0) {
+                std::cerr << std::format("{} kernel differs from scalar for {} with mantissaBits {}\n",
+                                         simdLevelName(level), typeName, mantissaBits);
+                identical = false;
+            }
+
+            std::cout << std::format(" {:>12.2f}", data.size() * sizeof(T) / bestSeconds / 1e9);
+        }
+        std::cout << "\n";
+    }
+
+    // In-place truncation must match out-of-place truncation
+    std::vector<T> inPlace = data;
+    truncateMantissas(inPlace, inPlace, digits / 2);
+    truncateMantissas(data, expected, digits / 2, SimdLevel::Scalar);
+    if (inPlace != expected) {
+        std::cerr << std::format("In-place truncation differs from scalar for {}\n", typeName);
+        identical = false;
+    }
+
+    std::cout << "\n";
+    return identical;
+}
+
+int main(int argc, char* argv[]) {
+    size_t numValues = (argc > 1) ? std::stoull(argv[1]) : 16 * 1024 * 1024;
+    int repetitions = (argc > 2) ? std::stoi(argv[2]) : 10;
+
+    std::cout << "Widest supported kernel: " << simdLevelName(detectSimdLevel()) << "\n\n";
+
+    bool identical = benchmarkKernels<float>("float", numValues, repetitions);
+    identical = benchmarkKernels<double>("double", numValues / 2, repetitions) && identical;
+
+    return identical ? 0 : 1;
+}
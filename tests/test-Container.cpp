@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "../utils/column.hpp"
+#include "../src/Container.hpp"
+#include "../src/TruncCompressor.hpp"
+
+int main(int argc, char* argv[]) {
+    std::string filename = (argc > 1) ? argv[1] : "test.rlc";
+
+    // Generate a random jagged column
+    std::mt19937 gen(42); // Fixed seed for reproducibility
+    std::uniform_real_distribution<float> dis(0.0f, 100.0f);
+    JaggedColumn<float> column;
+    for (int i = 0; i < 10000; ++i) {
+        std::vector<float> entry(gen() % 10); // Random number of jets per entry
+        for (auto& val : entry) {
+            val = dis(gen);
+        }
+        column.appendEntry(entry);
+    }
+
+    std::map<std::string, std::string> options{
+        {"compressionLevel", "5"},
+        {"mantissaBits", "13"}
+    };
+    TruncCompressor<float> compressor{options};
+
+    // Write the column as chunks of 1024 values, keeping the decompressed values for comparison
+    std::vector<size_t> boundaries = fixedChunkBoundaries(column.values.size(), 1024);
+    std::vector<float> decompressed(column.values.size());
+    {
+        ContainerWriter writer(filename, "BitTruncation", compressor.getConfig());
+        writer.beginBranch("AnalysisJetsAuxDyn.pt", ElementType::Float);
+        CompressedData compressed;
+        for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+            std::span<const float> chunk(column.values.data() + boundaries[i], boundaries[i + 1] - boundaries[i]);
+            compressor.compress(chunk, compressed);
+            compressor.decompress(compressed, std::span<float>(decompressed).subspan(boundaries[i], chunk.size()));
+            writer.writeChunk(compressed);
+        }
+        writer.endBranch(column.offsets);
+        writer.close();
+        std::cout << std::format("Wrote {} chunks, {} bytes to {}\n", boundaries.size() - 1, writer.bytesWritten(), filename);
+    }
+
+    // Read entry ranges back and compare with the decompressed values
+    ContainerReader reader(filename);
+    TruncCompressor<float> decompressor{reader.getConfig()};
+    std::cout << std::format("Compressor: {}, {} branch(es)\n\n", reader.getCompressorName(), reader.getBranches().size());
+
+    bool ok = true;
+    for (auto [firstEntry, endEntry] : {std::pair<uint64_t, uint64_t>{0, 1}, {0, 10000}, {4321, 4400}, {9999, 10000}, {500, 500}}) {
+        size_t chunksRead = 0;
+        JaggedColumn<float> entries = reader.readEntries<float>("AnalysisJetsAuxDyn.pt", firstEntry, endEntry, decompressor, &chunksRead);
+
+        bool match = entries.numEntries() == endEntry - firstEntry;
+        for (uint64_t entry = firstEntry; match && entry < endEntry; ++entry) {
+            std::span<const float> values = entries.entry(entry - firstEntry);
+            match = values.size() == column.entry(entry).size() &&
+                    std::equal(values.begin(), values.end(), decompressed.begin() + column.offsets[entry]);
+        }
+        ok = ok && match;
+        std::cout << std::format("Entries [{}, {}): {} chunk(s) read, {}\n", firstEntry, endEntry, chunksRead, match ? "match" : "MISMATCH");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../src/ErrorAccumulator.hpp"
+#include "../src/TruncKernels.hpp"
+
+int main(int argc, char* argv[]) {
+    // Generate random dummy data spanning several orders of magnitude
+    std::mt19937 gen(42); // Fixed seed for reproducibility
+    std::lognormal_distribution<float> dis(0.0f, 2.0f);
+    std::vector<float> data(200'000);
+    for (auto& val : data) {
+        val = dis(gen);
+    }
+
+    std::vector<float> sortedData = data;
+    std::sort(sortedData.begin(), sortedData.end());
+
+    bool ok = true;
+    for (int mantissaBits : {4, 8, 12, 16, 20}) {
+        std::vector<float> truncated(data.size());
+        truncateMantissas(data, truncated, mantissaBits);
+
+        // Reference: Wasserstein from the sorted samples, KS from the CDFs at every value
+        std::vector<float> sortedTruncated = truncated;
+        std::sort(sortedTruncated.begin(), sortedTruncated.end());
+        double referenceW = 0.0;
+        for (size_t i = 0; i < data.size(); ++i) {
+            referenceW += std::abs(static_cast<double>(sortedData[i]) - static_cast<double>(sortedTruncated[i]));
+        }
+        referenceW /= data.size();
+        double referenceKS = 0.0;
+        for (const std::vector<float>* sample : {&sortedData, &sortedTruncated}) {
+            for (float value : *sample) {
+                auto original = std::upper_bound(sortedData.begin(), sortedData.end(), value) - sortedData.begin();
+                auto decompressed = std::upper_bound(sortedTruncated.begin(), sortedTruncated.end(), value) - sortedTruncated.begin();
+                referenceKS = std::max(referenceKS, std::abs(static_cast<double>(original - decompressed)) / data.size());
+            }
+        }
+
+        // Chunks of uneven size, dealt to three accumulators and merged as worker threads do
+        std::vector<ErrorAccumulator<float>> workers(3, ErrorAccumulator<float>(true));
+        std::vector<ErrorAccumulator<float>> histogramWorkers(3, ErrorAccumulator<float>(false));
+        size_t chunkInx = 0;
+        for (size_t begin = 0; begin < data.size(); ++chunkInx) {
+            size_t size = std::min<size_t>(1000 + 997 * (chunkInx % 7), data.size() - begin);
+            std::span<const float> original = std::span<const float>(data).subspan(begin, size);
+            std::span<const float> decompressed = std::span<const float>(truncated).subspan(begin, size);
+            workers[chunkInx % 3].update(original, decompressed);
+            histogramWorkers[chunkInx % 3].update(original, decompressed);
+            begin += size;
+        }
+        ErrorAccumulator<float> errors(true);
+        ErrorAccumulator<float> histogramErrors;
+        for (size_t worker = 0; worker < workers.size(); ++worker) {
+            errors.merge(workers[worker]);
+            histogramErrors.merge(histogramWorkers[worker]);
+        }
+
+        // Merged on several threads, so slices split runs in the last passes
+        errors.mergeRuns(4);
+        double W = errors.WassersteinDistance();
+        double KS = errors.KSStatistic();
+        bool match = errors.count() == data.size() && std::abs(W - referenceW) <= 1e-9 * referenceW && KS == referenceKS;
+        ok = ok && match;
+        std::cout << std::format("mantissaBits {:>2}: W {:.6e} (reference {:.6e}, histogram {:.6e}), "
+                                 "KS {:.6f} (reference {:.6f}, histogram {:.6f}), {}\n",
+                                 mantissaBits, W, referenceW, histogramErrors.WassersteinDistance(),
+                                 KS, referenceKS, histogramErrors.KSStatistic(), match ? "match" : "MISMATCH");
+    }
+
+    std::cout << std::endl;
+
+    return ok ? 0 : 1;
+}
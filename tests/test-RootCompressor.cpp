@@ -0,0 +1,37 @@
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/RootCompressor.hpp"
+
+int main(int argc, char* argv[]) {
+    // Generate random dummy data, quantized so the lossless codecs have something to find
+    std::mt19937 gen(42); // Fixed seed for reproducibility
+    std::uniform_int_distribution<int> dis(0, 1000);
+    std::vector<float> data(10'000);
+    for (auto& val : data) {
+        val = dis(gen) * 0.25f;
+    }
+
+    // Every ROOT algorithm must give the data back exactly
+    bool ok = true;
+    for (const std::string& algorithm : {"zlib", "lzma", "lz4", "zstd"}) {
+        RootCompressor<float> compressor{{{"algorithm", algorithm}, {"compressionLevel", "5"}}};
+
+        CompressedData compressed;
+        std::vector<float> decompressed(data.size());
+        compressor.compress(data, compressed);
+        compressor.decompress(compressed, decompressed);
+
+        bool match = decompressed == data;
+        ok = ok && match;
+        std::cout << std::format("{:<24} {:>8} -> {:>8} bytes, {}\n", compressor.toString(), data.size() * sizeof(float),
+                                 compressed.numBytes, match ? "match" : "MISMATCH");
+    }
+
+    std::cout << std::endl;
+
+    return ok ? 0 : 1;
+}
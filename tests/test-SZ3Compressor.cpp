@@ -22,7 +22,7 @@ int main(int argc, char* argv[]) {
         {"errorBoundValue", std::to_string(errorBound)}
     };
 
-    SZ3Compressor compressor{options};
+    SZ3Compressor<float> compressor{options};
 
     // Generate random dummy data
     std::mt19937 gen(42); // Fixed seed for reproducibility
@@ -33,15 +33,17 @@ int main(int argc, char* argv[]) {
     }
 
     // Compress and decompress
-    CompressedData compressed = compressor.compress(data);
-    std::vector<float> decompressed = compressor.decompress(compressed);
+    CompressedData compressed;
+    std::vector<float> decompressed(data.size());
+    compressor.compress(data, compressed);
+    compressor.decompress(compressed, decompressed);
 
     // Print compressor details
     std::cout << "Compressor: " << compressor.toString() << "\n\n";   
 
     // Print length of float and byte vectors
     std::cout << "Length of float vector: " << data.size() << "\n";
-    std::cout << "Length of compressed byte vector: " << compressed.data.size() << "\n\n";
+    std::cout << "Length of compressed byte vector: " << compressed.numBytes << "\n\n";
 
     // Print original vs decompressed data side-by-side
     std::cout << std::format("{:<20} {:<20}\n", "Original", "Decompressed");
@@ -15,10 +15,31 @@ int main() {
     
     try {
         auto start = std::chrono::steady_clock::now();
-        std::vector<std::vector<float>> data = readVectorFloatBranch(filename, treename, branchname, 1e9);
+        JaggedColumn<float> data = readVectorFloatBranch(filename, treename, branchname, 1e9);
         auto end = std::chrono::steady_clock::now();
         std::chrono::duration<double> elapsed_seconds = end - start;
-        std::cout << "Read " << data.size() << " entries from branch '" << branchname << "' in " << elapsed_seconds.count() << " seconds." << std::endl;
+        std::cout << "Read " << data.numEntries() << " entries from branch '" << branchname << "' in " << elapsed_seconds.count() << " seconds." << std::endl;
+
+        // Stream the same branch in 64 KB chunks and check that the value counts agree
+        size_t totalValues = data.values.size();
+
+        start = std::chrono::steady_clock::now();
+        BranchChunkReader<float> reader(filename, treename, branchname, 64 * 1024, 1e9);
+        std::vector<float> chunk;
+        size_t numChunks = 0;
+        size_t streamedValues = 0;
+        while (reader.next(chunk)) {
+            numChunks += 1;
+            streamedValues += chunk.size();
+        }
+        end = std::chrono::steady_clock::now();
+        elapsed_seconds = end - start;
+        std::cout << "Streamed " << streamedValues << " values in " << numChunks << " chunks from branch '" << branchname << "' in " << elapsed_seconds.count() << " seconds." << std::endl;
+
+        if (streamedValues != totalValues) {
+            std::cerr << "Error: streamed " << streamedValues << " values, expected " << totalValues << std::endl;
+            return 1;
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
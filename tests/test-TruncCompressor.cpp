@@ -20,7 +20,7 @@ int main(int argc, char* argv[]) {
         {"mantissaBits", std::to_string(mantissaBits)}
     };
 
-    TruncCompressor compressor{options};
+    TruncCompressor<float> compressor{options};
 
     // Generate random dummy data
     std::mt19937 gen(42); // Fixed seed for reproducibility
@@ -31,15 +31,17 @@ int main(int argc, char* argv[]) {
     }
 
     // Compress and decompress
-    CompressedData compressed = compressor.compress(data);
-    std::vector<float> decompressed = compressor.decompress(compressed);
+    CompressedData compressed;
+    std::vector<float> decompressed(data.size());
+    compressor.compress(data, compressed);
+    compressor.decompress(compressed, decompressed);
 
     // Print compressor details
     std::cout << "Compressor: " << compressor.toString() << "\n\n";
 
     // Print length of float and byte vectors
     std::cout << "Length of float vector: " << data.size() << "\n";
-    std::cout << "Length of compressed byte vector: " << compressed.data.size() << "\n\n";
+    std::cout << "Length of compressed byte vector: " << compressed.numBytes << "\n\n";
 
     // Print original vs decompressed data side-by-side
     std::cout << std::format("{:<20} {:<20}\n", "Original", "Decompressed");
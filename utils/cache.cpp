@@ -0,0 +1,183 @@
+/**
+ * @file cache.cpp
+ * @brief Writing and memory-mapping column cache files.
+ */
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.hpp"
+#include "utils.hpp"
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'L', 'C', 'O', 'L', 'U', 'M', 'N'};
+constexpr uint32_t kVersion = 2;                // Version 1 cut columns at the limit of branches read with them
+constexpr uint64_t kValuesAlignment = 64;
+
+/**
+ * @brief Fixed-size part of a cache file's header; the key's identity string follows it.
+ */
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t elementType;
+    uint64_t numEntries;
+    uint64_t numValues;
+    uint64_t valuesPosition;
+    uint64_t offsetsPosition;
+    uint64_t idLength;
+};
+
+/**
+ * @brief 64-bit FNV-1a hash, stable across platforms and runs.
+ */
+uint64_t fnv1a(const std::string& text) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t alignUp(uint64_t position, uint64_t alignment) {
+    return (position + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+std::string columnCacheId(const ColumnCacheKey& key) {
+    std::filesystem::path path = std::filesystem::canonical(key.filename);
+    return std::format("{}|{}|{}|{}|{}|{}|{}|{}", path.string(), std::filesystem::file_size(path),
+                       std::filesystem::last_write_time(path).time_since_epoch().count(),
+                       key.treename, key.branchname, key.firstEntry, key.endEntry, key.maxBytes);
+}
+
+std::string columnCachePath(const std::string& cacheDir, const ColumnCacheKey& key) {
+    std::string name = key.branchname;
+    std::replace_if(name.begin(), name.end(), [](char c) { return c == '/' || c == '\\' || c == ':'; }, '_');
+    return (std::filesystem::path(cacheDir) / std::format("{}-{:016x}.rlcol", name, fnv1a(columnCacheId(key)))).string();
+}
+
+std::unique_ptr<MappedColumn> MappedColumn::open(const std::string& cacheDir, const ColumnCacheKey& key) {
+    std::string id = columnCacheId(key);
+    std::string path = columnCachePath(cacheDir, key);
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(CacheHeader))) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<MappedColumn> column(new MappedColumn());
+    column->size_ = static_cast<size_t>(info.st_size);
+    column->mapping_ = ::mmap(nullptr, column->size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (column->mapping_ == MAP_FAILED) {
+        column->mapping_ = nullptr;
+        return nullptr;
+    }
+
+    // Anything that does not match the key and this format is a miss, and gets rewritten
+    const uint8_t* bytes = static_cast<const uint8_t*>(column->mapping_);
+    CacheHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+                 header.elementType <= static_cast<uint32_t>(ElementType::Char) &&
+                 header.idLength == id.size() && sizeof(header) + header.idLength <= column->size_ &&
+                 std::memcmp(bytes + sizeof(header), id.data(), id.size()) == 0;
+    if (valid) {
+        size_t valueSize = elementSize(static_cast<ElementType>(header.elementType));
+        valid = header.valuesPosition % kValuesAlignment == 0 && header.offsetsPosition % sizeof(uint64_t) == 0 &&
+                header.valuesPosition <= column->size_ &&
+                header.numValues <= (column->size_ - header.valuesPosition) / valueSize &&
+                header.offsetsPosition <= column->size_ &&
+                header.numEntries < (column->size_ - header.offsetsPosition) / sizeof(uint64_t);
+    }
+    if (!valid) {
+        std::cout << timeMessage(std::format("Ignoring invalid cache file '{}'", path)) << std::endl;
+        return nullptr;
+    }
+
+    column->elementType_ = static_cast<ElementType>(header.elementType);
+    column->numEntries_ = header.numEntries;
+    column->numValues_ = header.numValues;
+    column->valuesPosition_ = header.valuesPosition;
+    column->offsetsPosition_ = header.offsetsPosition;
+
+    std::cout << timeMessage(std::format(
+        "Mapped {} entries ({} {} values, {}) of branch '{}' from cache '{}'",
+        column->numEntries_, column->numValues_, elementTypeName(column->elementType_),
+        getSizeString(column->numValues_ * elementSize(column->elementType_)), key.branchname, path
+    )) << std::endl;
+    return column;
+}
+
+MappedColumn::~MappedColumn() {
+    if (mapping_) {
+        ::munmap(mapping_, size_);
+    }
+}
+
+AnyColumnView MappedColumn::view() const {
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping_);
+    std::span<const uint64_t> offsets(reinterpret_cast<const uint64_t*>(bytes + offsetsPosition_), numEntries_ + 1);
+    return visitElementType(elementType_, [&](auto tag) -> AnyColumnView {
+        using T = typename decltype(tag)::type;
+        return JaggedColumnView<T>(std::span<const T>(reinterpret_cast<const T*>(bytes + valuesPosition_), numValues_), offsets);
+    });
+}
+
+void writeColumnCache(const std::string& cacheDir, const ColumnCacheKey& key, const AnyColumn& column) {
+    std::string id = columnCacheId(key);
+    std::string path = columnCachePath(cacheDir, key);
+    std::string tmpPath = std::format("{}.tmp.{}", path, ::getpid());
+    std::filesystem::create_directories(cacheDir);
+
+    std::visit([&](const auto& typed) {
+        using T = typename std::decay_t<decltype(typed)>::value_type;
+
+        CacheHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.elementType = static_cast<uint32_t>(elementTypeOf<T>());
+        header.numEntries = typed.numEntries();
+        header.numValues = typed.values.size();
+        header.idLength = id.size();
+        header.valuesPosition = alignUp(sizeof(header) + id.size(), kValuesAlignment);
+        header.offsetsPosition = alignUp(header.valuesPosition + typed.values.size() * sizeof(T), sizeof(uint64_t));
+
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        auto pad = [&file](uint64_t position) {
+            static const char zeros[kValuesAlignment] = {};
+            file.write(zeros, static_cast<std::streamsize>(position - file.tellp()));
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(id.data(), static_cast<std::streamsize>(id.size()));
+        pad(header.valuesPosition);
+        file.write(reinterpret_cast<const char*>(typed.values.data()), static_cast<std::streamsize>(typed.values.size() * sizeof(T)));
+        pad(header.offsetsPosition);
+        file.write(reinterpret_cast<const char*>(typed.offsets.data()), static_cast<std::streamsize>(typed.offsets.size() * sizeof(uint64_t)));
+        file.close();
+        if (!file) {
+            std::filesystem::remove(tmpPath);
+            throw std::runtime_error("Failed to write cache file '" + tmpPath + "'");
+        }
+    }, column);
+
+    std::filesystem::rename(tmpPath, path);
+    std::cout << timeMessage(std::format("Cached branch '{}' in '{}'", key.branchname, path)) << std::endl;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file cache.hpp
+ * @brief Memory-mapped cache of branches extracted from ROOT files, so repeat runs skip ROOT.
+ */
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "column.hpp"
+
+/**
+ * @brief What a cached column was extracted from.
+ *
+ * The input file is identified by its canonical path, size and modification time, so a
+ * cache entry goes stale as soon as the ROOT file is replaced or rewritten.
+ */
+struct ColumnCacheKey {
+    std::string filename{};                                         // Input ROOT file
+    std::string treename{};
+    std::string branchname{};
+    uint64_t firstEntry{0};                                         // First entry requested
+    uint64_t endEntry{std::numeric_limits<uint64_t>::max()};        // One past the last entry requested
+    uint64_t maxBytes{std::numeric_limits<uint64_t>::max()};        // Byte limit of the branch, read on its own
+};
+
+/**
+ * @brief Identity string of a key, including the input file's size and modification time.
+ *
+ * Stored in every cache file and compared on open.
+ *
+ * @throws std::filesystem::filesystem_error if the input file does not exist.
+ */
+std::string columnCacheId(const ColumnCacheKey& key);
+
+/**
+ * @brief Path of the cache file of a key within a cache directory.
+ *
+ * The file name is the branch name followed by a hash of columnCacheId(key).
+ */
+std::string columnCachePath(const std::string& cacheDir, const ColumnCacheKey& key);
+
+/**
+ * @class MappedColumn
+ * @brief A cached column, memory-mapped read-only from its cache file.
+ *
+ * Cache files hold a small header, the values (64-byte aligned) and the entry offsets
+ * (8-byte aligned) as raw arrays, so view() points straight into the mapping and nothing
+ * is deserialized or copied. The mapping is populated on open so the first benchmark
+ * trial does not pay the page faults.
+ */
+class MappedColumn {
+public:
+    /**
+     * @brief Map the cache file of a key.
+     * @return The mapped column, or nullptr if there is no cache file for the key or it is
+     *         stale, truncated or from another format version.
+     */
+    static std::unique_ptr<MappedColumn> open(const std::string& cacheDir, const ColumnCacheKey& key);
+
+    ~MappedColumn();
+
+    MappedColumn(const MappedColumn&) = delete;
+    MappedColumn& operator=(const MappedColumn&) = delete;
+
+    /** Element type of the values. */
+    ElementType getElementType() const { return elementType_; }
+
+    /**
+     * @brief View of the values and entry offsets, valid as long as this object lives.
+     */
+    AnyColumnView view() const;
+
+private:
+    MappedColumn() = default;
+
+    void* mapping_{nullptr};
+    size_t size_{};
+    ElementType elementType_{ElementType::Float};
+    uint64_t numEntries_{};
+    uint64_t numValues_{};
+    uint64_t valuesPosition_{};
+    uint64_t offsetsPosition_{};
+};
+
+/**
+ * @brief Write a column to the cache file of a key.
+ *
+ * The cache directory is created if needed. The file is written under a temporary name
+ * and renamed into place, so concurrent runs never map a partially written file.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeColumnCache(const std::string& cacheDir, const ColumnCacheKey& key, const AnyColumn& column);
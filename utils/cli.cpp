@@ -27,16 +27,20 @@ std::vector<std::string> tokenize(const std::string& str, char delimiter) {
 }
 
 std::map<std::string, std::string> parseBitTruncationOptions(std::vector<std::string> optionsList) {
-    // BitTruncation takes two options
+    // BitTruncation takes two or three options
     // 1: Number of mantissa bits to keep
-    // 2: Compression level for zlib
-    if (optionsList.size() != 3) {
-        throw std::runtime_error("BitTruncation requires exactly two options: mantissaBits and compressionLevel");
+    // 2: Compression level for the lossless backend
+    // 3: Lossless backend (zlib, zstd, lz4 or libdeflate; default zlib)
+    // 4: Shuffle before the backend (none, byte or bit; default none)
+    if (optionsList.size() < 3 || optionsList.size() > 5) {
+        throw std::runtime_error("BitTruncation requires options: mantissaBits, compressionLevel and optionally backend and shuffle");
     }
 
     std::map<std::string, std::string> optionsMap;
     optionsMap["mantissaBits"] = optionsList[1];
     optionsMap["compressionLevel"] = optionsList[2];
+    optionsMap["backend"] = (optionsList.size() >= 4) ? optionsList[3] : "zlib";
+    optionsMap["shuffle"] = (optionsList.size() >= 5) ? optionsList[4] : "none";
 
     return optionsMap;
 }
@@ -58,6 +62,98 @@ std::map<std::string, std::string> parseSZ3Options(std::vector<std::string> opti
     return optionsMap;
 }
 
+std::map<std::string, std::vector<std::string>> parseSweep(const std::string& spec) {
+    std::map<std::string, std::vector<std::string>> sweep;
+
+    for (const std::string& token : tokenize(spec, ',')) {
+        size_t equals = token.find('=');
+        if (equals == std::string::npos || equals == 0 || equals + 1 == token.size()) {
+            throw std::runtime_error("Sweep entries must look like option=values: " + token);
+        }
+        std::string option = token.substr(0, equals);
+        std::string values = token.substr(equals + 1);
+        std::vector<std::string>& list = sweep[option];
+
+        // Integer range start..end or start..end:step; anything else is a single value
+        size_t dots = values.find("..");
+        if (dots == std::string::npos) {
+            list.push_back(values);
+            continue;
+        }
+
+        size_t colon = values.find(':', dots);
+        int start = std::stoi(values.substr(0, dots));
+        int end = std::stoi(values.substr(dots + 2, colon == std::string::npos ? std::string::npos : colon - dots - 2));
+        int step = (colon == std::string::npos) ? 1 : std::stoi(values.substr(colon + 1));
+        if (step <= 0 || end < start) {
+            throw std::runtime_error("Sweep ranges must have start <= end and a positive step: " + token);
+        }
+        for (int value = start; value <= end; value += step) {
+            list.push_back(std::to_string(value));
+        }
+    }
+
+    return sweep;
+}
+
+std::map<std::string, std::string> parseRootOptions(std::vector<std::string> optionsList) {
+    // ROOT takes two options
+    // 1: Algorithm (zlib, lzma, lz4 or zstd)
+    // 2: Compression level (1-9)
+    if (optionsList.size() != 3) {
+        throw std::runtime_error("ROOT requires exactly two options: algorithm, compressionLevel");
+    }
+
+    std::map<std::string, std::string> optionsMap;
+    optionsMap["algorithm"] = optionsList[1];
+    optionsMap["compressionLevel"] = optionsList[2];
+
+    return optionsMap;
+}
+
+std::vector<std::pair<std::string, int>> parseRootCodecs(const std::string& spec) {
+    std::vector<std::pair<std::string, int>> codecs;
+    for (const std::string& token : tokenize(spec, ',')) {
+        size_t colon = token.find(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == token.size()) {
+            throw std::runtime_error("ROOT codecs must look like algorithm:level: " + token);
+        }
+        codecs.emplace_back(token.substr(0, colon), std::stoi(token.substr(colon + 1)));
+    }
+    if (codecs.empty()) {
+        throw std::runtime_error("--rootCodecs needs at least one algorithm:level");
+    }
+    return codecs;
+}
+
+std::vector<std::map<std::string, std::string>> expandSweep(
+    const std::map<std::string, std::string>& baseOptions,
+    const std::map<std::string, std::vector<std::string>>& sweep
+)
+{
+    for (const auto& [option, values] : sweep) {
+        if (!baseOptions.contains(option)) {
+            throw std::runtime_error("Cannot sweep '" + option + "': not an option of the compressor");
+        }
+    }
+
+    // Cartesian product, one option at a time
+    std::vector<std::map<std::string, std::string>> configs{baseOptions};
+    for (const auto& [option, values] : sweep) {
+        std::vector<std::map<std::string, std::string>> expanded;
+        expanded.reserve(configs.size() * values.size());
+        for (const auto& config : configs) {
+            for (const std::string& value : values) {
+                expanded.push_back(config);
+                expanded.back()[option] = value;
+            }
+        }
+        configs = std::move(expanded);
+    }
+
+    return configs;
+}
+
 /**
  * @brief Parse command-line arguments into an Args struct.
  * @param argc Number of command-line arguments.
@@ -81,8 +177,16 @@ const Args parseArgs(int argc, char* argv[]) {
             std::string branchesList = argv[++i];
             std::vector<std::string> branches = tokenize(branchesList, ',');
             args.branches = branches;
+        } else if (arg == "--readThreads" && i + 1 < argc) {
+            args.readThreads = std::stoi(argv[++i]);
         } else if (arg == "--chunkSize" && i + 1 < argc) {
             args.chunkSize = std::stoul(argv[++i]);
+        } else if (arg == "--chunking" && i + 1 < argc) {
+            args.chunking = argv[++i];
+            if (args.chunking != "fixed" && args.chunking != "entry" &&
+                args.chunking != "basket" && args.chunking != "cluster") {
+                throw std::runtime_error("Unsupported chunking policy: " + args.chunking);
+            }
         } else if (arg == "--compressor" && i + 1 < argc) {
             // Comma-separated compressor name and options
             // i.e. --compressor BitTruncation,12,1
@@ -93,9 +197,54 @@ const Args parseArgs(int argc, char* argv[]) {
                 args.compressionOptions = parseBitTruncationOptions(compressorList);
             } else if (args.compressor == "SZ3") {
                 args.compressionOptions = parseSZ3Options(compressorList);
-            }else {
+            } else if (args.compressor == "ROOT") {
+                args.compressionOptions = parseRootOptions(compressorList);
+            } else {
                 throw std::runtime_error("Unsupported compressor: " + args.compressor);
             }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            args.numThreads = std::stoi(argv[++i]);
+        } else if (arg == "--stream") {
+            args.stream = true;
+        } else if (arg == "--pipeline") {
+            args.pipeline = true;
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            args.warmupRuns = std::stoi(argv[++i]);
+        } else if (arg == "--trials" && i + 1 < argc) {
+            args.trials = std::stoi(argv[++i]);
+        } else if (arg == "--clock" && i + 1 < argc) {
+            args.clock = argv[++i];
+        } else if (arg == "--perfCounters") {
+            args.perfCounters = true;
+        } else if (arg == "--chunkRecords" && i + 1 < argc) {
+            args.chunkRecordsFile = argv[++i];
+        } else if (arg == "--exactDistributions") {
+            args.exactDistributions = true;
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            // Comma-separated option=values, i.e. --sweep mantissaBits=0..23,compressionLevel=1..9
+            args.sweep = parseSweep(argv[++i]);
+        } else if (arg == "--sweepThreads" && i + 1 < argc) {
+            args.sweepThreads = std::stoi(argv[++i]);
+        } else if (arg == "--tune" && i + 1 < argc) {
+            // option=min..max, i.e. --tune mantissaBits=0..23 or --tune errorBoundValue=1e-6..1e-1
+            args.tune = argv[++i];
+        } else if (arg == "--maxAbsError" && i + 1 < argc) {
+            args.maxAbsError = std::stod(argv[++i]);
+        } else if (arg == "--tuneSample" && i + 1 < argc) {
+            args.tuneSample = std::stod(argv[++i]);
+        } else if (arg == "--cacheDir" && i + 1 < argc) {
+            args.cacheDir = argv[++i];
+        } else if (arg == "--container" && i + 1 < argc) {
+            args.containerFile = argv[++i];
+        } else if (arg == "--randomAccess" && i + 1 < argc) {
+            args.randomAccessRanges = std::stoi(argv[++i]);
+        } else if (arg == "--rangeEntries" && i + 1 < argc) {
+            args.rangeEntries = std::stoi(argv[++i]);
+        } else if (arg == "--readBenchmark" && i + 1 < argc) {
+            args.readBenchmarkDir = argv[++i];
+        } else if (arg == "--rootCodecs" && i + 1 < argc) {
+            // Comma-separated algorithm:level, i.e. --rootCodecs zlib:1,lzma:5,zstd:5
+            args.rootCodecs = parseRootCodecs(argv[++i]);
         } else if (arg == "--resultsFile" && i + 1 < argc) {
             args.resultsFile = argv[++i];
         } else if (arg == "--writeDecompressed" && i + 1 < argc) {
@@ -106,10 +255,72 @@ const Args parseArgs(int argc, char* argv[]) {
         }
     }
 
+    // Streaming modes only see one chunk at a time, so they cannot follow the file's baskets or clusters
+    if ((args.stream || args.pipeline) && (args.chunking == "basket" || args.chunking == "cluster")) {
+        throw std::runtime_error("--chunking " + args.chunking + " is not supported with --stream or --pipeline");
+    }
+
+    // Warmup and trials repeat run() over the in-memory column
+    if ((args.warmupRuns != 0 || args.trials != 1) && (args.stream || args.pipeline)) {
+        throw std::runtime_error("--warmup and --trials are not supported with --stream or --pipeline");
+    }
+    if (args.perfCounters && (args.stream || args.pipeline)) {
+        throw std::runtime_error("--perfCounters is not supported with --stream or --pipeline");
+    }
+    if (!args.chunkRecordsFile.empty() && (args.stream || args.pipeline)) {
+        throw std::runtime_error("--chunkRecords is not supported with --stream or --pipeline");
+    }
+    // Exact distributions hold sorted copies of the whole column; the tuner only compares maxAbsError
+    if (args.exactDistributions && (args.stream || args.pipeline || !args.tune.empty())) {
+        throw std::runtime_error("--exactDistributions is not supported with --stream, --pipeline or --tune");
+    }
+    if (args.clock != "wall" && args.clock != "cpu") {
+        throw std::runtime_error("--clock must be wall or cpu");
+    }
+
+    // Decompressed branches are rebuilt from the in-memory columns' entry offsets
+    if (args.writeDecompressed && (args.stream || args.pipeline || !args.sweep.empty() || !args.tune.empty())) {
+        throw std::runtime_error("--writeDecompressed is not supported with --stream, --pipeline, --sweep or --tune");
+    }
+
+    // Streaming modes read from ROOT by design, so they cannot use the column cache
+    if (!args.cacheDir.empty() && (args.stream || args.pipeline)) {
+        throw std::runtime_error("--cacheDir is not supported with --stream or --pipeline");
+    }
+
+    // The container holds one configuration's chunks of the in-memory columns
+    if (!args.containerFile.empty() && (args.stream || args.pipeline || !args.sweep.empty() || !args.tune.empty())) {
+        throw std::runtime_error("--container is not supported with --stream, --pipeline, --sweep or --tune");
+    }
+
+    // The read benchmark writes one configuration's chunks of the in-memory columns
+    if (!args.readBenchmarkDir.empty() && (args.stream || args.pipeline || !args.sweep.empty() || !args.tune.empty())) {
+        throw std::runtime_error("--readBenchmark is not supported with --stream, --pipeline, --sweep or --tune");
+    }
+
+    // A sweep runs every configuration on the same in-memory column
+    if (!args.sweep.empty() && (args.stream || args.pipeline)) {
+        throw std::runtime_error("--sweep is not supported with --stream or --pipeline");
+    }
+
+    // Tuning searches on the in-memory column too, and needs a bound to search for
+    if (!args.tune.empty()) {
+        if (args.stream || args.pipeline) {
+            throw std::runtime_error("--tune is not supported with --stream or --pipeline");
+        }
+        if (args.maxAbsError < 0.0) {
+            throw std::runtime_error("--tune requires --maxAbsError <bound>");
+        }
+        if (!(args.tuneSample > 0.0 && args.tuneSample <= 1.0)) {
+            throw std::runtime_error("--tuneSample must be in (0,1]");
+        }
+    }
+
     // Check usage
     if (args.dataFile.empty() || args.treename.empty() || 
         args.branches.empty() || args.chunkSize == 0 || args.compressor.empty() ||
-        args.resultsFile.empty()) 
+        args.resultsFile.empty() || args.numThreads < 1 || args.sweepThreads < 1 ||
+        args.warmupRuns < 0 || args.trials < 1 || args.randomAccessRanges < 0 || args.rangeEntries < 1) 
     {
         usage();
         exit(1);
@@ -124,8 +335,21 @@ void usage() {
                 "--tree <name> "
                 "--branches <branch1,branch2,...> "
                 "--chunkSize <number> "
+                "[--chunking <fixed|entry|basket|cluster>] "
                 "--compressor <name,option1,option2,...> "
                 "--resultsFile <file> "
+                "[--threads <number>] "
+                "[--readThreads <number>] "
+                "[--cacheDir <dir>] "
+                "[--stream] "
+                "[--pipeline] "
+                "[--warmup <number>] [--trials <number>] [--clock <wall|cpu>] [--perfCounters] "
+                "[--chunkRecords <file.csv>] [--exactDistributions] "
+                "[--sweep <option=values,...>] "
+                "[--sweepThreads <number>] "
+                "[--tune <option=min..max> --maxAbsError <bound> [--tuneSample <fraction>]] "
+                "[--container <file> [--randomAccess <number>] [--rangeEntries <number>]] "
+                "[--readBenchmark <dir> [--rootCodecs <algorithm:level,...>]] "
                 "[--writeDecompressed <file>]"
                 "\n";
     std::cout << "Example: program "
@@ -134,14 +358,63 @@ void usage() {
                 "--branches AnalysisJetsAuxDyn.pt,AnalysisJetsAuxDyn.eta "
                 "--chunkSize 1024 "
                 "--compressor BitTruncation,12,1\n";
+    std::cout << "Options:\n";
+    std::cout << "  --chunking <policy> how chunks are cut (default fixed):\n";
+    std::cout << "                        fixed:   every <chunkSize> bytes, splitting entries\n";
+    std::cout << "                        entry:   at the last entry boundary within <chunkSize> bytes\n";
+    std::cout << "                        basket:  at the branch's basket boundaries in the file\n";
+    std::cout << "                        cluster: at the tree's cluster boundaries in the file\n";
+    std::cout << "                      (--stream and --pipeline support fixed and entry only)\n";
+    std::cout << "  --threads <number>  compress chunks in parallel on <number> worker threads (default 1)\n";
+    std::cout << "  --readThreads <n>   read branches with ROOT implicit multithreading on <n> threads (0 = all cores)\n";
+    std::cout << "  --cacheDir <dir>    map branches from a raw column cache in <dir>, reading and caching them on a miss\n";
+    std::cout << "  --stream            read and compress the branch chunk by chunk in bounded memory (single thread)\n";
+    std::cout << "  --pipeline          overlap reading, compression, decompression and metrics on separate threads\n";
+    std::cout << "  --warmup <n>        untimed passes over the data before timing (default 0)\n";
+    std::cout << "  --trials <n>        timed passes; throughputs are the median, with p5/p95/stddev (default 1)\n";
+    std::cout << "  --clock <clock>     time with the wall clock (wall, default) or per-thread CPU time (cpu)\n";
+    std::cout << "  --perfCounters      count cycles, instructions, cache and branch misses around each call\n";
+    std::cout << "                      (Linux perf_event_open; reported as cycles/byte and IPC, omitted if unavailable)\n";
+    std::cout << "  --chunkRecords <f>  append one CSV row per chunk (sizes, latencies, max error) to <f>\n";
+    std::cout << "  --exactDistributions compute Wasserstein and KS exactly from sorted values rather than histograms\n";
+    std::cout << "                      (two extra copies of each branch in memory, three while merging)\n";
+    std::cout << "  --sweep <spec>      read the data once and run every combination of compressor options in spec,\n";
+    std::cout << "                      e.g. mantissaBits=0..23,compressionLevel=1..9:2,backend=zlib,backend=zstd\n";
+    std::cout << "                      (start..end[:step] ranges are integer; repeat an option to list values;\n";
+    std::cout << "                      options not in spec keep their --compressor value)\n";
+    std::cout << "  --sweepThreads <n>  accumulate each sweep or tuning run's error metrics on <n> threads (default 1);\n";
+    std::cout << "                      configurations are still timed one at a time\n";
+    std::cout << "  --tune <range>      search option=min..max for the loosest setting with maxAbsError <= --maxAbsError,\n";
+    std::cout << "                      e.g. mantissaBits=0..23 or errorBoundValue=1e-6..1e-1; combined with --sweep,\n";
+    std::cout << "                      every sweep configuration is tuned and the Pareto front is reported\n";
+    std::cout << "  --maxAbsError <x>   error bound for --tune\n";
+    std::cout << "  --tuneSample <f>    fraction of chunks the search runs on before the full-data check (default 0.1)\n";
+    std::cout << "  --container <file>  write the compressed chunks of all branches to a ROOTLess container file,\n";
+    std::cout << "                      then time decompressing random entry ranges from it\n";
+    std::cout << "  --randomAccess <n>  random ranges read back per branch (default 1000, 0 = none)\n";
+    std::cout << "  --rangeEntries <n>  entries per random range (default 100)\n";
+    std::cout << "  --readBenchmark <dir>\n";
+    std::cout << "                      write each branch's compressed chunks as a ROOT tree in <dir>, and the branch\n";
+    std::cout << "                      with every --rootCodecs setting, then time open -> decompress -> values for each\n";
+    std::cout << "  --rootCodecs <list> native ROOT codecs to compare, algorithm:level with algorithm zlib, lzma, lz4 or zstd\n";
+    std::cout << "                      (default zlib:1,zlib:6,lzma:5,lz4:4,zstd:5)\n";
+    std::cout << "  --writeDecompressed <file>\n";
+    std::cout << "                      write the decompressed branches, with their original entries, to one tree in <file>\n";
     std::cout << "Supported compressors:\n";
-    std::cout << "  --compressor BitTruncation,<mantissaBits>,<compressionLevel>\n";
-    std::cout << "    where <mantissaBits>: number of mantissa bits to keep (0-23 for float)\n";
-    std::cout << "          <compressionLevel>: zlib compression level (0-9)\n";
+    std::cout << "  --compressor BitTruncation,<mantissaBits>,<compressionLevel>[,<backend>[,<shuffle>]]\n";
+    std::cout << "    where <mantissaBits>: number of mantissa bits to keep (0-23 for float, 0-52 for double)\n";
+    std::cout << "          <compressionLevel>: compression level of the backend\n";
+    std::cout << "          <backend>: lossless backend (default zlib):\n";
+    std::cout << "                       zlib (0-9), zstd (ZSTD_minCLevel-22), lz4 (0 = fast, 1-12 = HC), libdeflate (0-12)\n";
+    std::cout << "          <shuffle>: transpose before the backend: none (default), byte or bit\n";
     std::cout << "  --compressor SZ3,<algorithm>,<errorBoundMode>,<errorBoundValue>\n";
     std::cout << "    where <algorithm>: 0=interp+lorenzo, 1=interp+regression, 2=lorenzo only, 3=regression only\n";
     std::cout << "          <errorBoundMode>: 0=absolute, 1=relative\n";
     std::cout << "          <errorBoundValue>: float\n";
+    std::cout << "  --compressor ROOT,<algorithm>,<compressionLevel>\n";
+    std::cout << "    where <algorithm>: ROOT's built-in lossless algorithm: zlib, lzma, lz4 or zstd\n";
+    std::cout << "          <compressionLevel>: 1-9, as in ROOT's compression settings\n";
+    std::cout << "    (R__zip over the flat native-endian values of each chunk, not ROOT's serialized baskets)\n";
 }
 
 void printArgs(const Args& args) {
@@ -153,7 +426,13 @@ void printArgs(const Args& args) {
         std::cout << "\t" << branch << std::endl;
     }
 
+    std::cout << "Read threads: " << (args.readThreads < 0 ? std::string("serial") : std::to_string(args.readThreads)) << std::endl;
+    if (!args.cacheDir.empty()) {
+        std::cout << "Column cache: " << args.cacheDir << std::endl;
+    }
+
     std::cout << "Chunk size: " << args.chunkSize << std::endl;
+    std::cout << "Chunking: " << args.chunking << std::endl;
 
     std::cout << "Compressor: " << args.compressor << std::endl;
     std::cout << "Compression options: " << std::endl;
@@ -161,6 +440,42 @@ void printArgs(const Args& args) {
         std::cout << "\t" << key << ": " << value << std::endl;
     }   
 
+    std::cout << "Threads: " << args.numThreads << std::endl;
+    std::cout << "Streaming: " << (args.stream ? "yes" : "no") << std::endl;
+    std::cout << "Pipelined: " << (args.pipeline ? "yes" : "no") << std::endl;
+    std::cout << "Timing: " << args.warmupRuns << " warmup run(s), " << args.trials << " trial(s), "
+              << args.clock << " clock" << std::endl;
+    std::cout << "Hardware counters: " << (args.perfCounters ? "yes" : "no") << std::endl;
+    if (!args.chunkRecordsFile.empty()) {
+        std::cout << "Chunk records: " << args.chunkRecordsFile << std::endl;
+    }
+    std::cout << "Exact distributions: " << (args.exactDistributions ? "yes" : "no") << std::endl;
+
+    if (!args.tune.empty()) {
+        std::cout << "Tune: " << args.tune << " for maxAbsError <= " << args.maxAbsError
+                  << " on " << args.tuneSample * 100 << "% of chunks" << std::endl;
+    }
+
+    if (!args.sweep.empty()) {
+        std::cout << "Sweep (" << args.sweepThreads << " thread(s)): " << std::endl;
+        for (const auto& [option, values] : args.sweep) {
+            std::cout << "\t" << option << ": " << values.size() << " value(s)" << std::endl;
+        }
+    }
+
+    if (!args.containerFile.empty()) {
+        std::cout << "Container: " << args.containerFile << ", " << args.randomAccessRanges << " random range(s) of "
+                  << args.rangeEntries << " entries" << std::endl;
+    }
+
+    if (!args.readBenchmarkDir.empty()) {
+        std::cout << "Read benchmark: " << args.readBenchmarkDir << ", against";
+        for (const auto& [algorithm, level] : args.rootCodecs) {
+            std::cout << " " << algorithm << ":" << level;
+        }
+        std::cout << std::endl;
+    }
+
     std::cout << "Results will be written to: " << args.resultsFile << std::endl;
 
     if (args.writeDecompressed) {
@@ -7,6 +7,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -17,11 +18,40 @@ struct Args {
     std::string dataFile{};
     std::string treename{};
     std::vector<std::string> branches{};
+    int readThreads{-1};        // Threads for the implicit-MT reader (-1 = serial reader, 0 = all cores)
+    std::string cacheDir{};     // Directory of the raw column cache (empty = always read from ROOT)
 
     size_t chunkSize{};
+    std::string chunking{"fixed"};     // Chunking policy: fixed, entry, basket or cluster
     std::string compressor{};
     std::map<std::string, std::string> compressionOptions{};
 
+    int numThreads{1};
+    bool stream{false};
+    bool pipeline{false};
+    int warmupRuns{0};          // Untimed passes over the data before the trials
+    int trials{1};              // Timed passes; throughputs are reported as their median
+    std::string clock{"wall"};  // Clock compression is timed with: "wall" or "cpu" (per-thread CPU time)
+    bool perfCounters{false};   // Count hardware events around compress/decompress calls
+    std::string chunkRecordsFile{};     // CSV file receiving one row per chunk (empty = no chunk records)
+    bool exactDistributions{false};     // Exact Wasserstein and KS from sorted values instead of histograms
+
+    std::map<std::string, std::vector<std::string>> sweep{};    // Values to sweep per compressor option (empty = no sweep)
+    int sweepThreads{1};        // Threads for the error metrics of each sweep or tuning run
+
+    std::string tune{};         // Option to auto-tune and its range, option=min..max (empty = no tuning)
+    double maxAbsError{-1.0};   // Error bound the tuned option must meet (required with --tune)
+    double tuneSample{0.1};     // Fraction of chunks the tuning search runs on
+
+    std::string containerFile{};        // Container file receiving the compressed chunks (empty = none)
+    int randomAccessRanges{1000};       // Random entry ranges read back from the container
+    int rangeEntries{100};              // Entries per random range
+
+    std::string readBenchmarkDir{};     // Directory receiving the read benchmark's ROOT files (empty = no read benchmark)
+    std::vector<std::pair<std::string, int>> rootCodecs{
+        {"zlib", 1}, {"zlib", 6}, {"lzma", 5}, {"lz4", 4}, {"zstd", 5}
+    };                                  // Native ROOT algorithms and levels the read benchmark compares against
+
     std::string resultsFile{};
     
     bool writeDecompressed{false};
@@ -30,8 +60,42 @@ struct Args {
 
 std::vector<std::string> tokenize(const std::string& str, char delimiter);
 
+/**
+ * @brief Parse a list of ROOT codecs, e.g. "zlib:1,lzma:5,zstd:5".
+ * @return Algorithm name and level of each codec, in the given order.
+ * @throws std::runtime_error if a codec is not algorithm:level.
+ */
+std::vector<std::pair<std::string, int>> parseRootCodecs(const std::string& spec);
+
 std::map<std::string, std::string> parseBitTruncationOptions(std::vector<std::string> optionsList);
 std::map<std::string, std::string> parseSZ3Options(std::vector<std::string> optionsList);
+std::map<std::string, std::string> parseRootOptions(std::vector<std::string> optionsList);
+
+/**
+ * @brief Parse a sweep specification into the values to try for each compressor option.
+ *
+ * The specification is a comma-separated list of option=values, where values is a single
+ * value, an inclusive integer range start..end, or a range with a step start..end:step.
+ * Repeating an option adds values to its list, e.g. "backend=zlib,backend=zstd".
+ *
+ * @param spec Sweep specification, e.g. "mantissaBits=0..23,compressionLevel=1..9".
+ * @return Map of option name to the values to sweep, in the given order.
+ * @throws std::runtime_error if the specification is malformed.
+ */
+std::map<std::string, std::vector<std::string>> parseSweep(const std::string& spec);
+
+/**
+ * @brief Expand a sweep into every combination of option values.
+ * @param baseOptions Options from --compressor; swept options replace their values.
+ * @param sweep Values to sweep per option (see parseSweep()).
+ * @return One set of compressor options per configuration, in nested-loop order with
+ *         the last option varying fastest.
+ * @throws std::runtime_error if a swept option is not an option of the compressor.
+ */
+std::vector<std::map<std::string, std::string>> expandSweep(
+    const std::map<std::string, std::string>& baseOptions,
+    const std::map<std::string, std::vector<std::string>>& sweep
+);
 
 /**
  * @brief Parse command-line arguments into an Args struct.
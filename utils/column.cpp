@@ -0,0 +1,95 @@
+/**
+ * @file column.cpp
+ * @brief Element type names and chunk boundary policies for flat columns.
+ */
+#include <algorithm>
+#include <stdexcept>
+
+#include "column.hpp"
+
+std::string elementTypeName(ElementType type) {
+    switch (type) {
+        case ElementType::Float:
+            return "float";
+        case ElementType::Double:
+            return "double";
+        case ElementType::Int:
+            return "int";
+        case ElementType::Char:
+            return "char";
+    }
+    throw std::invalid_argument("Unknown element type");
+}
+
+size_t elementSize(ElementType type) {
+    return visitElementType(type, [](auto tag) { return sizeof(typename decltype(tag)::type); });
+}
+
+std::vector<size_t> fixedChunkBoundaries(size_t numValues, size_t maxValues) {
+    if (maxValues == 0) {
+        throw std::invalid_argument("Chunks must hold at least one value");
+    }
+
+    std::vector<size_t> boundaries;
+    boundaries.reserve(numValues / maxValues + 2);
+    for (size_t start = 0; start < numValues; start += maxValues) {
+        boundaries.push_back(start);
+    }
+    boundaries.push_back(numValues);
+    return boundaries;
+}
+
+std::vector<size_t> entryAlignedChunkBoundaries(std::span<const uint64_t> offsets, size_t maxValues) {
+    if (maxValues == 0) {
+        throw std::invalid_argument("Chunks must hold at least one value");
+    }
+
+    std::vector<size_t> boundaries{0};
+    size_t numValues = offsets.back();
+    size_t chunkStart = 0;
+    size_t entry = 0;
+    size_t numEntries = offsets.size() - 1;
+
+    while (chunkStart < numValues) {
+        // Find the first entry that would end past the chunk limit
+        auto limit = std::upper_bound(offsets.begin() + entry + 1, offsets.end(), chunkStart + maxValues);
+        size_t lastEntry = std::distance(offsets.begin(), limit) - 1;
+
+        // Always make progress, even if a single entry exceeds the limit
+        if (lastEntry == entry) {
+            lastEntry = entry + 1;
+        }
+        lastEntry = std::min(lastEntry, numEntries);
+
+        chunkStart = offsets[lastEntry];
+        entry = lastEntry;
+        if (chunkStart > boundaries.back()) {
+            boundaries.push_back(chunkStart);
+        }
+    }
+
+    if (boundaries.back() != numValues) {
+        boundaries.push_back(numValues);
+    }
+    return boundaries;
+}
+
+std::vector<size_t> entryRangeChunkBoundaries(std::span<const uint64_t> offsets, std::span<const uint64_t> firstEntries) {
+    size_t numEntries = offsets.size() - 1;
+
+    std::vector<size_t> boundaries{0};
+    for (uint64_t entry : firstEntries) {
+        if (entry >= numEntries) {
+            break;
+        }
+        // Skip empty ranges (e.g. baskets of entries with no values)
+        if (offsets[entry] > boundaries.back()) {
+            boundaries.push_back(offsets[entry]);
+        }
+    }
+
+    if (offsets.back() > boundaries.back()) {
+        boundaries.push_back(offsets.back());
+    }
+    return boundaries;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file column.hpp
+ * @brief Flat columnar layout for jagged (vector-per-entry) branches.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Element types of the jagged branches ROOTLess can benchmark.
+ *
+ * Float16_t branches are float in memory, so they are read as Float.
+ */
+enum class ElementType {
+    Float,      ///< vector<float>
+    Double,     ///< vector<double>
+    Int,        ///< vector<int>
+    Char        ///< vector<char>
+};
+
+/**
+ * @brief ElementType of a C++ element type, checked at compile time.
+ */
+template <typename T>
+constexpr ElementType elementTypeOf() {
+    if constexpr (std::is_same_v<T, float>) {
+        return ElementType::Float;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return ElementType::Double;
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+        return ElementType::Int;
+    } else {
+        static_assert(std::is_same_v<T, char>, "Unsupported element type");
+        return ElementType::Char;
+    }
+}
+
+/**
+ * @brief Human-readable name of an element type, as used in ROOT ("float", "double", ...).
+ */
+std::string elementTypeName(ElementType type);
+
+/**
+ * @brief Size of one element of a given type, in bytes.
+ */
+size_t elementSize(ElementType type);
+
+/**
+ * @brief Call f with the C++ type matching an element type.
+ *
+ * f is called as f(std::type_identity<T>{}), so each element type gets its own
+ * compile-time specialized instantiation of f.
+ */
+template <typename F>
+decltype(auto) visitElementType(ElementType type, F&& f) {
+    switch (type) {
+        case ElementType::Float:
+            return f(std::type_identity<float>{});
+        case ElementType::Double:
+            return f(std::type_identity<double>{});
+        case ElementType::Int:
+            return f(std::type_identity<int32_t>{});
+        case ElementType::Char:
+            return f(std::type_identity<char>{});
+    }
+    throw std::invalid_argument("Unknown element type");
+}
+
+/**
+ * @struct JaggedColumn
+ * @brief Values of a jagged branch in one contiguous array, plus per-entry offsets.
+ *
+ * Entry i holds values[offsets[i]] .. values[offsets[i + 1] - 1], so offsets always has
+ * numEntries() + 1 elements and starts at 0. Keeping the offsets preserves event
+ * boundaries (e.g. jet multiplicity) that flattening would otherwise throw away.
+ */
+template <typename T>
+struct JaggedColumn {
+    using value_type = T;
+
+    std::vector<T> values{};                ///< Values of all entries, back to back
+    std::vector<uint64_t> offsets{0};       ///< Start of each entry in values, plus the end
+
+    /**
+     * @brief Number of entries (events) in the column.
+     */
+    size_t numEntries() const {
+        return offsets.size() - 1;
+    }
+
+    /**
+     * @brief View of the values of one entry.
+     * @param entry Entry index.
+     */
+    std::span<const T> entry(size_t entry) const {
+        return std::span<const T>(values).subspan(offsets[entry], offsets[entry + 1] - offsets[entry]);
+    }
+
+    /**
+     * @brief Append one entry's values to the end of the column.
+     * @param entry Values of the new entry.
+     */
+    void appendEntry(std::span<const T> entry) {
+        values.insert(values.end(), entry.begin(), entry.end());
+        offsets.push_back(values.size());
+    }
+
+    /**
+     * @brief Keep only the first numEntries entries.
+     * @param numEntries Number of entries to keep, at most numEntries().
+     */
+    void truncate(size_t numEntries) {
+        values.resize(offsets[numEntries]);
+        offsets.resize(numEntries + 1);
+    }
+
+    /**
+     * @brief Append all entries of another column, shifting its offsets.
+     * @param other Column whose entries follow this column's entries.
+     */
+    void append(const JaggedColumn& other) {
+        uint64_t base = values.size();
+        values.insert(values.end(), other.values.begin(), other.values.end());
+        for (size_t i = 1; i < other.offsets.size(); ++i) {
+            offsets.push_back(base + other.offsets[i]);
+        }
+    }
+};
+
+/**
+ * @brief A column of any supported element type.
+ */
+using AnyColumn = std::variant<JaggedColumn<float>, JaggedColumn<double>, JaggedColumn<int32_t>, JaggedColumn<char>>;
+
+/**
+ * @struct JaggedColumnView
+ * @brief Non-owning view of a jagged column's values and entry offsets.
+ *
+ * Lets benchmarks run on a JaggedColumn as well as on values and offsets that live
+ * elsewhere, e.g. in a memory-mapped column cache, without copying them.
+ */
+template <typename T>
+struct JaggedColumnView {
+    using value_type = T;
+
+    std::span<const T> values{};
+    std::span<const uint64_t> offsets{};
+
+    JaggedColumnView() = default;
+    JaggedColumnView(std::span<const T> values, std::span<const uint64_t> offsets)
+        : values(values), offsets(offsets) {}
+    JaggedColumnView(const JaggedColumn<T>& column)
+        : values(column.values), offsets(column.offsets) {}
+
+    /**
+     * @brief Number of entries (events) in the column.
+     */
+    size_t numEntries() const {
+        return offsets.size() - 1;
+    }
+
+    /**
+     * @brief View of the values of one entry.
+     * @param entry Entry index.
+     */
+    std::span<const T> entry(size_t entry) const {
+        return values.subspan(offsets[entry], offsets[entry + 1] - offsets[entry]);
+    }
+
+    /**
+     * @brief View of the first numEntries entries.
+     * @param numEntries Number of entries to keep, at most numEntries().
+     */
+    JaggedColumnView first(size_t numEntries) const {
+        return JaggedColumnView(values.first(offsets[numEntries]), offsets.first(numEntries + 1));
+    }
+};
+
+/**
+ * @brief A view of a column of any supported element type.
+ */
+using AnyColumnView = std::variant<JaggedColumnView<float>, JaggedColumnView<double>, JaggedColumnView<int32_t>, JaggedColumnView<char>>;
+
+/**
+ * @brief View of a column, whatever its element type.
+ */
+inline AnyColumnView viewOf(const AnyColumn& column) {
+    return std::visit([](const auto& typed) -> AnyColumnView {
+        return JaggedColumnView<typename std::decay_t<decltype(typed)>::value_type>(typed);
+    }, column);
+}
+
+/**
+ * @brief Element type held by a column.
+ */
+inline ElementType elementTypeOf(const AnyColumn& column) {
+    return std::visit([](const auto& typed) {
+        return elementTypeOf<typename std::decay_t<decltype(typed)>::value_type>();
+    }, column);
+}
+
+/**
+ * @brief Element type of a column view.
+ */
+inline ElementType elementTypeOf(const AnyColumnView& column) {
+    return std::visit([](const auto& typed) {
+        return elementTypeOf<typename std::decay_t<decltype(typed)>::value_type>();
+    }, column);
+}
+
+/**
+ * @brief Entry offsets of a column, whatever its element type.
+ */
+inline std::span<const uint64_t> offsetsOf(const AnyColumn& column) {
+    return std::visit([](const auto& typed) { return std::span<const uint64_t>(typed.offsets); }, column);
+}
+
+/**
+ * @brief Chunk boundaries of fixed size, ignoring entry boundaries.
+ * @param numValues Total number of values.
+ * @param maxValues Number of values per chunk (the last chunk may be shorter).
+ * @return Value offsets where chunks start, followed by numValues.
+ */
+std::vector<size_t> fixedChunkBoundaries(size_t numValues, size_t maxValues);
+
+/**
+ * @brief Chunk boundaries that never split an entry.
+ *
+ * Each chunk is closed at the last entry boundary that keeps it within maxValues. An
+ * entry larger than maxValues on its own becomes a chunk by itself.
+ *
+ * @param offsets Entry offsets of the column (see JaggedColumn::offsets).
+ * @param maxValues Maximum number of values per chunk.
+ * @return Value offsets where chunks start, followed by the total number of values.
+ */
+std::vector<size_t> entryAlignedChunkBoundaries(std::span<const uint64_t> offsets, size_t maxValues);
+
+/**
+ * @brief Chunk boundaries at given entry numbers, e.g. the file's basket or cluster starts.
+ *
+ * Entry numbers beyond the end of the column (when it was read only partially) are ignored,
+ * and empty chunks are dropped.
+ *
+ * @param offsets Entry offsets of the column (see JaggedColumn::offsets).
+ * @param firstEntries Sorted entry numbers at which a new chunk starts.
+ * @return Value offsets where chunks start, followed by the total number of values.
+ */
+std::vector<size_t> entryRangeChunkBoundaries(std::span<const uint64_t> offsets, std::span<const uint64_t> firstEntries);
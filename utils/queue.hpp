@@ -0,0 +1,64 @@
+/**
+ * @file queue.hpp
+ * @brief Bounded lock-free single-producer/single-consumer queue.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class SPSCQueue
+ * @brief Fixed-capacity ring buffer safe for exactly one producer and one consumer thread.
+ *
+ * push() and pop() never block or allocate; they return false when the queue is full or
+ * empty, and the caller decides how to wait.
+ */
+template <typename T>
+class SPSCQueue {
+public:
+    /**
+     * @brief Construct a queue.
+     * @param capacity Maximum number of items held at once.
+     */
+    explicit SPSCQueue(size_t capacity) : buffer_(capacity + 1) {}
+
+    /**
+     * @brief Append an item (producer thread only).
+     * @return False if the queue is full.
+     */
+    bool push(const T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t next = increment(head);
+        if (next == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        buffer_[head] = item;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer thread only).
+     * @return False if the queue is empty.
+     */
+    bool pop(T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buffer_[tail];
+        tail_.store(increment(tail), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> buffer_;                     ///< Ring storage, one slot larger than capacity
+    alignas(64) std::atomic<size_t> head_{0};   ///< Next slot to write (owned by producer)
+    alignas(64) std::atomic<size_t> tail_{0};   ///< Next slot to read (owned by consumer)
+
+    size_t increment(size_t index) const {
+        return (index + 1 == buffer_.size()) ? 0 : index + 1;
+    }
+};
@@ -4,13 +4,21 @@
  * @file root.cpp
  * @brief Utilities for reading from and writing to ROOT files using TTree and branches.
  */
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <span>
 #include <string>
 #include <stdexcept>
 #include <vector>
 
 #include <unistd.h>
 
+#include <Compression.h>
+#include <ROOT/TSeq.hxx>
+#include <ROOT/TThreadExecutor.hxx>
+#include <TROOT.h>
 #include <TTreeReader.h>
 #include <TTreeReaderValue.h>
 #include <TFile.h>
@@ -21,6 +29,210 @@
 #include "root.hpp"
 #include "utils.hpp"
 
+namespace {
+
+/**
+ * @brief Opens a ROOT file for reading.
+ * @param filename Path to the ROOT file.
+ * @return Owning pointer to the open file.
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+std::unique_ptr<TFile> openRootFile(const std::string& filename) {
+    // Suppress warnings like the following:
+    // Warning in <TClass::Init>: no dictionary for class xAOD::EventInfo_v1 is available
+    // We're just reading vector branches of plain numbers here, so we don't actually need the info for any of these ATLAS classes
+    gErrorIgnoreLevel = kError;
+
+    std::unique_ptr<TFile> file;
+
+    try {
+        file.reset(TFile::Open(filename.c_str(), "READ"));
+    } catch (const std::exception& e) {
+        std::cerr << "Error opening file: " << e.what() << std::endl;
+        exit(1);
+    }
+
+    if (!file || file->IsZombie()) {
+        throw std::runtime_error("Failed to open file");
+    }
+
+    return file;
+}
+
+/**
+ * @brief Gets a tree from an open ROOT file.
+ * @throws std::runtime_error if the tree does not exist.
+ */
+TTree* getTree(TFile& file, const std::string& treename) {
+    TTree* tree = file.Get<TTree>(treename.c_str());
+    if (!tree) {
+        throw std::runtime_error("Failed to find tree '" + treename + "' in file");
+    }
+    return tree;
+}
+
+/**
+ * @brief Gets the element type of a std::vector branch of an open tree.
+ * @throws std::runtime_error if the branch does not exist or has an unsupported type.
+ */
+ElementType branchElementType(TTree& tree, const std::string& branchname) {
+    TBranch* branch = tree.GetBranch(branchname.c_str());
+    if (!branch) {
+        throw std::runtime_error("Failed to find branch '" + branchname + "' in tree '" + tree.GetName() + "'");
+    }
+
+    static const std::map<std::string, ElementType> elementTypes{
+        {"vector<float>", ElementType::Float},
+        {"vector<Float16_t>", ElementType::Float},
+        {"vector<double>", ElementType::Double},
+        {"vector<Double32_t>", ElementType::Double},
+        {"vector<int>", ElementType::Int},
+        {"vector<char>", ElementType::Char},
+    };
+
+    std::string className = branch->GetClassName();
+    auto it = elementTypes.find(className);
+    if (it == elementTypes.end()) {
+        throw std::runtime_error(std::format(
+            "Branch '{}' has unsupported type '{}'", branchname, className));
+    }
+    return it->second;
+}
+
+/**
+ * @brief Reads one branch of a TTreeReader into a column, whatever its element type.
+ *
+ * Lets a single reader loop serve branches of different element types.
+ */
+class BranchFiller {
+public:
+    virtual ~BranchFiller() = default;
+
+    /** Size of the reader's current entry, in bytes. */
+    virtual size_t entryBytes() const = 0;
+
+    /** Size of the values read so far, in bytes. */
+    virtual size_t columnBytes() const = 0;
+
+    /** Append the reader's current entry to the column. */
+    virtual void appendEntry() = 0;
+
+    /** Move the column out of the filler. */
+    virtual AnyColumn take() = 0;
+};
+
+template <typename T>
+class TypedBranchFiller : public BranchFiller {
+public:
+    TypedBranchFiller(TTreeReader& reader, const std::string& branchname)
+        : value_(reader, branchname.c_str()) {}
+
+    size_t entryBytes() const override {
+        return value_->size() * sizeof(T);
+    }
+
+    size_t columnBytes() const override {
+        return column_.values.size() * sizeof(T);
+    }
+
+    void appendEntry() override {
+        column_.appendEntry(*value_);
+    }
+
+    AnyColumn take() override {
+        return std::move(column_);
+    }
+
+private:
+    mutable TTreeReaderValue<std::vector<T>> value_;    ///< TTreeReaderValue::Get() is not const
+    JaggedColumn<T> column_;
+};
+
+/**
+ * @brief Attach a filler of the given element type to a reader.
+ */
+std::unique_ptr<BranchFiller> makeBranchFiller(ElementType type, TTreeReader& reader, const std::string& branchname) {
+    return visitElementType(type, [&](auto tag) -> std::unique_ptr<BranchFiller> {
+        return std::make_unique<TypedBranchFiller<typename decltype(tag)::type>>(reader, branchname);
+    });
+}
+
+/**
+ * @brief Writes the entries of one column to a branch of a TTree, whatever its element type.
+ *
+ * Lets a single fill loop serve branches of different element types.
+ */
+class BranchWriter {
+public:
+    virtual ~BranchWriter() = default;
+
+    /** Number of entries in the column. */
+    virtual size_t numEntries() const = 0;
+
+    /** Copy one entry of the column into the branch's buffer, ready for TTree::Fill(). */
+    virtual void setEntry(size_t entry) = 0;
+};
+
+template <typename T>
+class TypedBranchWriter : public BranchWriter {
+public:
+    TypedBranchWriter(TTree& tree, const std::string& branchname, const JaggedColumnView<T>& column, int basketSize)
+        : column_(column)
+    {
+        if (!tree.Branch(branchname.c_str(), &bufferAddress_, basketSize)) {
+            throw std::runtime_error("Failed to create branch '" + branchname + "'");
+        }
+    }
+
+    size_t numEntries() const override {
+        return column_.numEntries();
+    }
+
+    void setEntry(size_t entry) override {
+        std::span<const T> values = column_.entry(entry);
+        buffer_.assign(values.begin(), values.end());
+    }
+
+private:
+    JaggedColumnView<T> column_;
+    std::vector<T> buffer_;                         ///< Current entry; its capacity is reused by every entry
+    std::vector<T>* bufferAddress_{&buffer_};       ///< TTree::Branch() keeps the address of this pointer
+};
+
+/**
+ * @brief Attach a writer for a column of any element type to a new branch of a tree.
+ */
+std::unique_ptr<BranchWriter> makeBranchWriter(TTree& tree, const std::string& branchname, const AnyColumnView& column, int basketSize) {
+    return std::visit([&](const auto& typed) -> std::unique_ptr<BranchWriter> {
+        using T = typename std::decay_t<decltype(typed)>::value_type;
+        return std::make_unique<TypedBranchWriter<T>>(tree, branchname, typed, basketSize);
+    }, column);
+}
+
+/**
+ * @brief Element types of several branches of a tree, in the order given.
+ */
+std::vector<ElementType> branchElementTypes(TTree& tree, const std::vector<std::string>& branchnames) {
+    std::vector<ElementType> types;
+    for (const std::string& branchname : branchnames) {
+        types.push_back(branchElementType(tree, branchname));
+    }
+    return types;
+}
+
+/**
+ * @brief Number of leading entries of a column whose values fit in maxBytes, i.e. the
+ *        entries readVectorBranches() keeps before it stops at its byte limit.
+ */
+size_t entriesWithinBytes(const AnyColumn& column, size_t maxBytes) {
+    return std::visit([&](const auto& typed) -> size_t {
+        uint64_t maxValues = maxBytes / sizeof(typename std::decay_t<decltype(typed)>::value_type);
+        return std::upper_bound(typed.offsets.begin() + 1, typed.offsets.end(), maxValues) - (typed.offsets.begin() + 1);
+    }, column);
+}
+
+} // namespace
+
 /**
  * @brief Reads all float values from a specified branch in a ROOT file.
  *
@@ -33,41 +245,24 @@
  * @param treename    Name of the tree in the file.
  * @param branchname  Name of the branch to read.
  * @param maxBytes    Maximum number of bytes to read (stops early if exceeded).
- * @return std::vector<float> containing all float values from the branch.
+ * @return JaggedColumn containing all float values from the branch and their entry offsets.
  * @throws std::runtime_error if file or tree cannot be opened.
  */
-std::vector<std::vector<float>> readVectorFloatBranch(
+JaggedColumn<float> readVectorFloatBranch(
     const std::string& filename, 
     const std::string& treename, 
     const std::string& branchname, 
     size_t maxBytes
 ) 
 {
-    // Suppress warnings like the following:
-    // Warning in <TClass::Init>: no dictionary for class xAOD::EventInfo_v1 is available
-    // We're just reading vector<float> branches here, so we don't actually need the info for any of these ATLAS classes
-    gErrorIgnoreLevel = kError;
-
     // Open the ROOT file
-    TFile* file = nullptr; 
-    
-    try {
-        file = TFile::Open(filename.c_str(), "READ");
-    } catch (const std::exception& e) {
-        std::cerr << "Error opening file: " << e.what() << std::endl;
-        exit(1);
-    }
-
-    if (!file || file->IsZombie()) {
-        throw std::runtime_error("Failed to open file");
-        exit(1);
-    }
+    std::unique_ptr<TFile> file = openRootFile(filename);
 
     // Use TTreeReader for efficient reading
-    TTreeReader reader(treename.c_str(), file);
+    TTreeReader reader(treename.c_str(), file.get());
     TTreeReaderValue<std::vector<float>> branch(reader, branchname.c_str());
 
-    std::vector<std::vector<float>> entries;
+    JaggedColumn<float> column;
     Long64_t bytesRead{0};
     Long64_t totalValues{0};
 
@@ -80,35 +275,537 @@ std::vector<std::vector<float>> readVectorFloatBranch(
         if (bytesRead + (branch->size() * sizeof(float)) > maxBytes) {
             std::cout << timeMessage(std::format(
                 "Reached maxBytes limit ({} bytes), stopping read after {} entries", 
-                getSizeString(maxBytes), entries.size()
+                getSizeString(maxBytes), column.numEntries()
             ));
             std::cout << std::endl;
             break;
         }
-        entries.push_back(*branch);
+        column.appendEntry(*branch);
         totalValues += static_cast<Long64_t>(branch->size());
         bytesRead += static_cast<Long64_t>(branch->size() * sizeof(float));
     }
 
     file->Close();
-    delete file;
 
     std::cout << timeMessage(std::format(
         "Read {} entries ({} float values, {}) from branch '{}'", 
-        entries.size(), totalValues, getSizeString(bytesRead), branchname
+        column.numEntries(), totalValues, getSizeString(bytesRead), branchname
     )) << std::endl;
 
-    return entries;
+    return column;
+}
+
+ElementType readBranchElementType(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname
+)
+{
+    std::unique_ptr<TFile> file = openRootFile(filename);
+    ElementType type = branchElementType(*getTree(*file, treename), branchname);
+    file->Close();
+    return type;
+}
+
+std::map<std::string, AnyColumn> readVectorBranches(
+    const std::string& filename,
+    const std::string& treename,
+    const std::vector<std::string>& branchnames,
+    size_t maxBytes
+)
+{
+    // Open the ROOT file
+    std::unique_ptr<TFile> file = openRootFile(filename);
+    std::vector<ElementType> types = branchElementTypes(*getTree(*file, treename), branchnames);
+
+    // Attach one filler per branch so a single loop serves all of them
+    TTreeReader reader(treename.c_str(), file.get());
+    std::vector<std::unique_ptr<BranchFiller>> branches;
+    for (size_t i = 0; i < branchnames.size(); ++i) {
+        branches.push_back(makeBranchFiller(types[i], reader, branchnames[i]));
+    }
+
+    Long64_t numEntries{0};
+
+    std::cout << timeMessage(std::format(
+        "Reading entries from {} branches in file '{}'",
+        branchnames.size(), filename)
+    ) << std::endl;
+
+    bool limitReached = false;
+    while (!limitReached && reader.Next()) {
+        // Check every branch first so all buffers stop at the same entry
+        for (size_t i = 0; i < branches.size(); ++i) {
+            if (branches[i]->columnBytes() + branches[i]->entryBytes() > maxBytes) {
+                std::cout << timeMessage(std::format(
+                    "Reached maxBytes limit ({} bytes) on branch '{}', stopping read after {} entries",
+                    getSizeString(maxBytes), branchnames[i], numEntries
+                )) << std::endl;
+                limitReached = true;
+                break;
+            }
+        }
+        if (limitReached) {
+            break;
+        }
+
+        for (const auto& branch : branches) {
+            branch->appendEntry();
+        }
+        numEntries += 1;
+    }
+
+    file->Close();
+
+    std::map<std::string, AnyColumn> result;
+    for (size_t i = 0; i < branchnames.size(); ++i) {
+        size_t numBytes = branches[i]->columnBytes();
+        std::cout << timeMessage(std::format(
+            "Read {} entries ({} {} values, {}) from branch '{}'",
+            numEntries, numBytes / elementSize(types[i]), elementTypeName(types[i]),
+            getSizeString(numBytes), branchnames[i]
+        )) << std::endl;
+        result[branchnames[i]] = branches[i]->take();
+    }
+
+    return result;
+}
+
+std::map<std::string, AnyColumn> readVectorBranchesMT(
+    const std::string& filename,
+    const std::string& treename,
+    const std::vector<std::string>& branchnames,
+    unsigned int numThreads,
+    size_t maxBytes
+)
+{
+    // Also makes ROOT thread-safe and lets TTree unzip baskets of a range in parallel
+    ROOT::EnableImplicitMT(numThreads);
+    unsigned int poolSize = std::max(ROOT::GetThreadPoolSize(), 1u);
+
+    // Collect cluster boundaries; clusters never share baskets, so ranges read independently
+    std::vector<std::pair<Long64_t, Long64_t>> clusters;
+    std::vector<ElementType> types;
+    {
+        std::unique_ptr<TFile> file = openRootFile(filename);
+        TTree* tree = getTree(*file, treename);
+        types = branchElementTypes(*tree, branchnames);
+
+        Long64_t numEntries = tree->GetEntries();
+        TTree::TClusterIterator clusterIt = tree->GetClusterIterator(0);
+        Long64_t start;
+        while ((start = clusterIt()) < numEntries) {
+            clusters.emplace_back(start, std::min(clusterIt.GetNextEntry(), numEntries));
+        }
+        file->Close();
+    }
+
+    std::cout << timeMessage(std::format(
+        "Reading up to {} clusters from {} branches in file '{}' on {} threads",
+        clusters.size(), branchnames.size(), filename, poolSize)
+    ) << std::endl;
+
+    std::vector<AnyColumn> columns;
+    for (ElementType type : types) {
+        columns.push_back(visitElementType(type, [](auto tag) -> AnyColumn {
+            return JaggedColumn<typename decltype(tag)::type>{};
+        }));
+    }
+
+    // Reads clusters [firstCluster, lastCluster) as a few tasks per thread, so each task opens
+    // the file once, then appends them to columns in entry order
+    ROOT::TThreadExecutor executor(poolSize);
+    auto readClusters = [&](size_t firstCluster, size_t lastCluster) {
+        size_t numClusters = lastCluster - firstCluster;
+        size_t numTasks = std::min<size_t>(numClusters, poolSize * 4);
+        std::vector<std::pair<Long64_t, Long64_t>> ranges(numTasks);
+        for (size_t t = 0; t < numTasks; ++t) {
+            size_t first = firstCluster + numClusters * t / numTasks;
+            size_t last = firstCluster + numClusters * (t + 1) / numTasks;
+            ranges[t] = {clusters[first].first, clusters[last - 1].second};
+        }
+
+        // rangeColumns[task][branch] holds the entries of one entry range
+        std::vector<std::vector<AnyColumn>> rangeColumns(
+            numTasks, std::vector<AnyColumn>(branchnames.size())
+        );
+
+        executor.Foreach([&](size_t task) {
+            std::unique_ptr<TFile> file = openRootFile(filename);
+            TTreeReader reader(treename.c_str(), file.get());
+            reader.SetEntriesRange(ranges[task].first, ranges[task].second);
+
+            std::vector<std::unique_ptr<BranchFiller>> branches;
+            for (size_t i = 0; i < branchnames.size(); ++i) {
+                branches.push_back(makeBranchFiller(types[i], reader, branchnames[i]));
+            }
+
+            while (reader.Next()) {
+                for (const auto& branch : branches) {
+                    branch->appendEntry();
+                }
+            }
+            file->Close();
+
+            for (size_t i = 0; i < branches.size(); ++i) {
+                rangeColumns[task][i] = branches[i]->take();
+            }
+        }, ROOT::TSeqUL(numTasks));
+
+        // Concatenate ranges in entry order, releasing each range column as it is copied
+        for (size_t i = 0; i < branchnames.size(); ++i) {
+            std::visit([&](auto& typed) {
+                using Column = std::decay_t<decltype(typed)>;
+
+                size_t numValues = typed.values.size();
+                size_t numEntries = typed.numEntries();
+                for (const auto& columns : rangeColumns) {
+                    const Column& range = std::get<Column>(columns[i]);
+                    numValues += range.values.size();
+                    numEntries += range.numEntries();
+                }
+
+                typed.values.reserve(numValues);
+                typed.offsets.reserve(numEntries + 1);
+                for (auto& columns : rangeColumns) {
+                    typed.append(std::get<Column>(columns[i]));
+                    columns[i] = Column{};
+                }
+            }, columns[i]);
+        }
+    };
+
+    // Without a limit, read every cluster at once. With one, read waves of clusters, each
+    // sized from the bytes per entry seen so far, until the limit is crossed, then cut at
+    // the same entry as the serial reader, so both read the same data.
+    size_t nextCluster = 0;
+    size_t numEntries = 0;
+    while (nextCluster < clusters.size()) {
+        size_t lastCluster = clusters.size();
+        if (maxBytes != std::numeric_limits<size_t>::max()) {
+            // The first wave is one cluster per thread; later ones aim at the remaining budget
+            lastCluster = std::min(clusters.size(), nextCluster + poolSize);
+            if (numEntries > 0) {
+                double entriesLeft = std::numeric_limits<double>::max();
+                for (const AnyColumn& column : columns) {
+                    double columnBytes = std::visit([](const auto& typed) {
+                        return static_cast<double>(typed.values.size() * sizeof(typename std::decay_t<decltype(typed)>::value_type));
+                    }, column);
+                    if (columnBytes > 0) {
+                        entriesLeft = std::min(entriesLeft, (maxBytes - columnBytes) / (columnBytes / numEntries));
+                    }
+                }
+                Long64_t targetEntry = static_cast<Long64_t>(std::min(numEntries + entriesLeft, static_cast<double>(clusters.back().second)));
+                while (lastCluster < clusters.size() && clusters[lastCluster - 1].second <= targetEntry) {
+                    ++lastCluster;
+                }
+            }
+        }
+
+        readClusters(nextCluster, lastCluster);
+        nextCluster = lastCluster;
+        numEntries = std::visit([](const auto& typed) { return typed.numEntries(); }, columns.front());
+
+        size_t keptEntries = numEntries;
+        size_t limitBranch = 0;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            size_t branchEntries = entriesWithinBytes(columns[i], maxBytes);
+            if (branchEntries < keptEntries) {
+                keptEntries = branchEntries;
+                limitBranch = i;
+            }
+        }
+        if (keptEntries < numEntries) {
+            std::cout << timeMessage(std::format(
+                "Reached maxBytes limit ({} bytes) on branch '{}', stopping read after {} entries",
+                getSizeString(maxBytes), branchnames[limitBranch], keptEntries
+            )) << std::endl;
+            for (AnyColumn& column : columns) {
+                std::visit([&](auto& typed) { typed.truncate(keptEntries); }, column);
+            }
+            break;
+        }
+    }
+
+    std::map<std::string, AnyColumn> result;
+    for (size_t i = 0; i < branchnames.size(); ++i) {
+        std::visit([&](const auto& typed) {
+            size_t numBytes = typed.values.size() * sizeof(typename std::decay_t<decltype(typed)>::value_type);
+            std::cout << timeMessage(std::format(
+                "Read {} entries ({} {} values, {}) from branch '{}'",
+                typed.numEntries(), typed.values.size(), elementTypeName(types[i]),
+                getSizeString(numBytes), branchnames[i]
+            )) << std::endl;
+        }, columns[i]);
+        result[branchnames[i]] = std::move(columns[i]);
+    }
+
+    return result;
+}
+
+std::vector<uint64_t> readBasketBoundaries(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname
+)
+{
+    std::unique_ptr<TFile> file = openRootFile(filename);
+    TTree* tree = getTree(*file, treename);
+
+    TBranch* branch = tree->GetBranch(branchname.c_str());
+    if (!branch) {
+        throw std::runtime_error("Failed to find branch '" + branchname + "' in tree '" + treename + "'");
+    }
+
+    // GetBasketEntry() holds the first entry of each written basket
+    Int_t numBaskets = branch->GetWriteBasket();
+    const Long64_t* basketEntries = branch->GetBasketEntry();
+    std::vector<uint64_t> boundaries(basketEntries, basketEntries + numBaskets);
+
+    file->Close();
+    return boundaries;
+}
+
+std::vector<uint64_t> readClusterBoundaries(
+    const std::string& filename,
+    const std::string& treename
+)
+{
+    std::unique_ptr<TFile> file = openRootFile(filename);
+    TTree* tree = getTree(*file, treename);
+
+    std::vector<uint64_t> boundaries;
+    Long64_t numEntries = tree->GetEntries();
+    TTree::TClusterIterator clusterIt = tree->GetClusterIterator(0);
+    Long64_t start;
+    while ((start = clusterIt()) < numEntries) {
+        boundaries.push_back(start);
+    }
+
+    file->Close();
+    return boundaries;
+}
+
+template <typename T>
+struct BranchChunkReader<T>::Impl {
+    std::string branchname;
+    std::unique_ptr<TFile> file;
+    std::unique_ptr<TTreeReader> reader;
+    std::unique_ptr<TTreeReaderValue<std::vector<T>>> branch;
+
+    size_t elementsPerChunk{};
+    size_t maxBytes{};
+    bool alignToEntries{false};
+
+    bool inEntry{false};        ///< True while the current entry still has values to hand out
+    bool finished{false};       ///< True once the tree or maxBytes is exhausted
+    size_t entryPos{};          ///< Next value to copy from the current entry
+    size_t entriesRead{};
+    size_t valuesRead{};
+};
+
+template <typename T>
+BranchChunkReader<T>::BranchChunkReader(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname,
+    size_t chunkSize,
+    size_t maxBytes,
+    bool alignToEntries
+)
+    : impl_(std::make_unique<Impl>())
+{
+    impl_->branchname = branchname;
+    impl_->file = openRootFile(filename);
+
+    ElementType type = branchElementType(*getTree(*impl_->file, treename), branchname);
+    if (type != elementTypeOf<T>()) {
+        throw std::runtime_error(std::format(
+            "Branch '{}' holds vector<{}>, not vector<{}>",
+            branchname, elementTypeName(type), elementTypeName(elementTypeOf<T>())));
+    }
+
+    impl_->reader = std::make_unique<TTreeReader>(treename.c_str(), impl_->file.get());
+    impl_->branch = std::make_unique<TTreeReaderValue<std::vector<T>>>(*impl_->reader, branchname.c_str());
+    impl_->elementsPerChunk = std::max<size_t>(chunkSize / sizeof(T), 1);
+    impl_->maxBytes = maxBytes;
+    impl_->alignToEntries = alignToEntries;
+
+    std::cout << timeMessage(std::format(
+        "Streaming entries from branch '{}' in file '{}' in {} chunks",
+        branchname, filename, getSizeString(chunkSize))
+    ) << std::endl;
+}
+
+template <typename T>
+BranchChunkReader<T>::~BranchChunkReader() = default;
+
+template <typename T>
+bool BranchChunkReader<T>::next(std::vector<T>& chunk) {
+    Impl& state = *impl_;
+    chunk.clear();
+
+    while (chunk.size() < state.elementsPerChunk && !state.finished) {
+        // Advance to the next entry once the current one has been fully copied
+        if (!state.inEntry) {
+            if (!state.reader->Next()) {
+                state.finished = true;
+                break;
+            }
+
+            const std::vector<T>& values = **state.branch;
+            if ((state.valuesRead + values.size()) * sizeof(T) > state.maxBytes) {
+                std::cout << timeMessage(std::format(
+                    "Reached maxBytes limit ({} bytes), stopping read after {} entries",
+                    getSizeString(state.maxBytes), state.entriesRead
+                )) << std::endl;
+                state.finished = true;
+                break;
+            }
+
+            state.inEntry = true;
+            state.entryPos = 0;
+            state.entriesRead += 1;
+            state.valuesRead += values.size();
+        }
+
+        // When aligning to entries, keep an entry that does not fit for the next chunk
+        const std::vector<T>& values = **state.branch;
+        if (state.alignToEntries && !chunk.empty() && chunk.size() + values.size() > state.elementsPerChunk) {
+            break;
+        }
+
+        // Copy as much of the current entry as fits in the chunk, or all of it when aligning to entries
+        size_t space = state.alignToEntries ? values.size() : state.elementsPerChunk - chunk.size();
+        size_t count = std::min(values.size() - state.entryPos, space);
+        chunk.insert(chunk.end(), values.begin() + state.entryPos, values.begin() + state.entryPos + count);
+        state.entryPos += count;
+
+        if (state.entryPos == values.size()) {
+            state.inEntry = false;
+        }
+    }
+
+    if (state.finished && chunk.empty() && state.file) {
+        state.file->Close();
+        std::cout << timeMessage(std::format(
+            "Streamed {} entries ({} {} values, {}) from branch '{}'",
+            state.entriesRead, state.valuesRead, elementTypeName(elementTypeOf<T>()), getSizeString(state.valuesRead * sizeof(T)), state.branchname
+        )) << std::endl;
+        state.branch.reset();
+        state.reader.reset();
+        state.file.reset();
+    }
+
+    return !chunk.empty();
+}
+
+template <typename T>
+size_t BranchChunkReader<T>::getEntriesRead() const {
+    return impl_->entriesRead;
+}
+
+template <typename T>
+size_t BranchChunkReader<T>::getValuesRead() const {
+    return impl_->valuesRead;
+}
+
+template class BranchChunkReader<float>;
+template class BranchChunkReader<double>;
+template class BranchChunkReader<int32_t>;
+template class BranchChunkReader<char>;
+
+int rootCompressionSettings(const std::string& algorithm, int level) {
+    static const std::map<std::string, ROOT::RCompressionSetting::EAlgorithm::EValues> algorithms{
+        {"zlib", ROOT::RCompressionSetting::EAlgorithm::kZLIB},
+        {"lzma", ROOT::RCompressionSetting::EAlgorithm::kLZMA},
+        {"lz4", ROOT::RCompressionSetting::EAlgorithm::kLZ4},
+        {"zstd", ROOT::RCompressionSetting::EAlgorithm::kZSTD},
+    };
+
+    auto it = algorithms.find(algorithm);
+    if (it == algorithms.end()) {
+        throw std::invalid_argument("Unknown ROOT compression algorithm: " + algorithm);
+    }
+    if (level < 0 || level > 9) {
+        throw std::invalid_argument(std::format("ROOT compression level must be in 0..9, got {}", level));
+    }
+    return ROOT::CompressionSettings(it->second, level);
 }
 
-// void writeDecompressedDataToRootFile(
-//     const Args& args, 
-//     const std::string& branch,
-//     const std::vector<float>& data
-// ) {
-//     // Create file if it does not exist
+void writeVectorBranches(
+    const std::string& filename,
+    const std::string& treename,
+    const std::map<std::string, AnyColumnView>& columns,
+    int compressionSettings,
+    int basketSize,
+    long long autoFlushBytes
+)
+{
+    if (columns.empty()) {
+        throw std::invalid_argument("No columns to write");
+    }
+
+    std::unique_ptr<TFile> file(compressionSettings < 0
+        ? TFile::Open(filename.c_str(), "RECREATE")
+        : TFile::Open(filename.c_str(), "RECREATE", "", compressionSettings));
+    if (!file || file->IsZombie()) {
+        throw std::runtime_error("Failed to create file '" + filename + "'");
+    }
+
+    // The file owns the tree and deletes it on Close()
+    TTree* tree = new TTree(treename.c_str(), "ROOTLess branches");
+    tree->SetDirectory(file.get());
+    tree->SetAutoFlush(-autoFlushBytes);
+
+    std::vector<std::unique_ptr<BranchWriter>> branches;
+    size_t numValues = 0;
+    for (const auto& [branchname, column] : columns) {
+        branches.push_back(makeBranchWriter(*tree, branchname, column, basketSize));
+        numValues += std::visit([](const auto& typed) { return typed.values.size(); }, column);
+    }
+
+    size_t numEntries = branches.front()->numEntries();
+    for (const auto& branch : branches) {
+        if (branch->numEntries() != numEntries) {
+            throw std::invalid_argument("All columns must have the same number of entries");
+        }
+    }
+
+    std::cout << timeMessage(std::format(
+        "Writing {} entries of {} branches ({} values) to tree '{}' in file '{}'",
+        numEntries, branches.size(), numValues, treename, filename
+    )) << std::endl;
+
+    // One pass over the entries fills every branch at once
+    for (size_t entry = 0; entry < numEntries; ++entry) {
+        for (const auto& branch : branches) {
+            branch->setEntry(entry);
+        }
+        if (tree->Fill() < 0) {
+            throw std::runtime_error(std::format("Failed to fill entry {} of tree '{}'", entry, treename));
+        }
+    }
 
-//     // Check if tree exists
-//     // If no, create tree and write branch as normal
-//     // If yes, write new branch to tree
-// }
\ No newline at end of file
+    if (tree->Write() <= 0) {
+        throw std::runtime_error("Failed to write tree '" + treename + "' to file '" + filename + "'");
+    }
+    file->Close();
+
+    std::cout << timeMessage(std::format("Wrote {} entries to file '{}'", numEntries, filename)) << std::endl;
+}
+
+void writeDecompressedDataToRootFile(
+    const std::string& filename,
+    const std::string& treename,
+    const std::map<std::string, AnyColumn>& columns,
+    int basketSize,
+    long long autoFlushBytes
+)
+{
+    std::map<std::string, AnyColumnView> views;
+    for (const auto& [branchname, column] : columns) {
+        views.emplace(branchname, viewOf(column));
+    }
+    writeVectorBranches(filename, treename, views, -1, basketSize, autoFlushBytes);
+}
\ No newline at end of file
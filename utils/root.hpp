@@ -5,8 +5,14 @@
  */
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 #include "cli.hpp"
+#include "column.hpp"
 
 /**
  * @brief Reads all values from a specified branch in a ROOT file.
@@ -15,18 +21,211 @@
  * @param treename    Name of the tree in the file.
  * @param branchname  Name of the branch to read.
  * @param maxBytes    Maximum number of bytes to read (stops early if exceeded).
- * @return std::vector<float> containing all float values from the branch.
+ * @return JaggedColumn containing all float values from the branch and their entry offsets.
  * @throws std::runtime_error if file or tree cannot be opened.
  */
-std::vector<std::vector<float>> readVectorFloatBranch(
+JaggedColumn<float> readVectorFloatBranch(
     const std::string& filename, 
     const std::string& treename, 
     const std::string& branchname, 
     size_t maxBytes = 1024 * 1024 * 1024
 ); 
 
-// void writeDecompressedDataToRootFile(
-//     const Args& args, 
-//     const std::string& branch,
-//     const std::vector<float>& data
-// );
\ No newline at end of file
+/**
+ * @brief Reads the element type of a std::vector branch from its class name.
+ *
+ * vector<Float16_t> and vector<Double32_t> are float and double in memory, so they
+ * are reported as Float and Double.
+ *
+ * @param filename    Path to the ROOT file.
+ * @param treename    Name of the tree in the file.
+ * @param branchname  Name of the branch.
+ * @return Element type of the branch.
+ * @throws std::runtime_error if file, tree or branch cannot be opened, or the branch
+ *         is not a vector of a supported element type.
+ */
+ElementType readBranchElementType(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname
+);
+
+/**
+ * @brief Reads several std::vector branches in a single pass over a tree.
+ *
+ * The element type of each branch is read from the file, and one TTreeReaderValue of
+ * that type is attached per branch. Every entry is appended to that branch's column,
+ * so ROOT decompresses each basket once no matter how many branches are requested.
+ *
+ * @param filename     Path to the ROOT file.
+ * @param treename     Name of the tree in the file.
+ * @param branchnames  Names of the branches to read.
+ * @param maxBytes     Maximum number of bytes to read per branch; reading stops for all
+ *                     branches at the first entry that would exceed it, so all buffers
+ *                     cover the same entries.
+ * @return Map of branch name to column of values and entry offsets.
+ * @throws std::runtime_error if file or tree cannot be opened.
+ */
+std::map<std::string, AnyColumn> readVectorBranches(
+    const std::string& filename,
+    const std::string& treename,
+    const std::vector<std::string>& branchnames,
+    size_t maxBytes = 1024 * 1024 * 1024
+);
+
+/**
+ * @brief Reads several std::vector branches using ROOT's implicit multithreading.
+ *
+ * Enables ROOT::EnableImplicitMT and splits the tree at its cluster boundaries into
+ * contiguous entry ranges. Each range is read by a task of a ROOT::TThreadExecutor with
+ * its own TFile and TTreeReader, so baskets of different clusters are decompressed and
+ * deserialized in parallel. Per-range columns are then concatenated, so the output is in
+ * entry order, as with readVectorBranches.
+ *
+ * With a byte limit, clusters are read in waves sized from the bytes per entry read so
+ * far, and the columns are cut at the same entry as readVectorBranches would stop at, so
+ * both readers return the same data for the same limit.
+ *
+ * @param filename     Path to the ROOT file.
+ * @param treename     Name of the tree in the file.
+ * @param branchnames  Names of the branches to read.
+ * @param numThreads   Number of threads for ROOT's implicit multithreading (0 = all cores).
+ * @param maxBytes     Maximum number of bytes to read per branch (default: the whole tree).
+ * @return Map of branch name to column of values and entry offsets.
+ * @throws std::runtime_error if file or tree cannot be opened.
+ */
+std::map<std::string, AnyColumn> readVectorBranchesMT(
+    const std::string& filename,
+    const std::string& treename,
+    const std::vector<std::string>& branchnames,
+    unsigned int numThreads = 0,
+    size_t maxBytes = std::numeric_limits<size_t>::max()
+);
+
+/**
+ * @brief Reads the first entry number of every basket of a branch.
+ * @param filename    Path to the ROOT file.
+ * @param treename    Name of the tree in the file.
+ * @param branchname  Name of the branch.
+ * @return Sorted entry numbers at which each basket starts.
+ * @throws std::runtime_error if file, tree or branch cannot be opened.
+ */
+std::vector<uint64_t> readBasketBoundaries(
+    const std::string& filename,
+    const std::string& treename,
+    const std::string& branchname
+);
+
+/**
+ * @brief Reads the first entry number of every cluster of a tree.
+ * @param filename    Path to the ROOT file.
+ * @param treename    Name of the tree in the file.
+ * @return Sorted entry numbers at which each cluster starts.
+ * @throws std::runtime_error if file or tree cannot be opened.
+ */
+std::vector<uint64_t> readClusterBoundaries(
+    const std::string& filename,
+    const std::string& treename
+);
+
+/**
+ * @class BranchChunkReader
+ * @brief Streams a std::vector<T> branch as fixed-size chunks of flat values.
+ *
+ * Entries are read with TTreeReader and copied straight into a caller-provided buffer,
+ * so at most one chunk of the branch is held in memory at a time. Entries that do not
+ * fit in the current chunk are continued in the next one, unless chunks are aligned to
+ * entries, in which case a chunk is closed before an entry that would not fit.
+ */
+template <typename T>
+class BranchChunkReader {
+public:
+    /**
+     * @brief Open a branch for streaming.
+     *
+     * @param filename    Path to the ROOT file.
+     * @param treename    Name of the tree in the file.
+     * @param branchname  Name of the branch to read.
+     * @param chunkSize   Size of each chunk, in bytes.
+     * @param maxBytes    Maximum number of bytes to read (stops early if exceeded).
+     * @param alignToEntries If true, never split an entry across chunks (an entry larger
+     *                       than chunkSize becomes a chunk on its own).
+     * @throws std::runtime_error if file or tree cannot be opened, or the branch does
+     *         not hold std::vector<T>.
+     */
+    BranchChunkReader(
+        const std::string& filename,
+        const std::string& treename,
+        const std::string& branchname,
+        size_t chunkSize,
+        size_t maxBytes = std::numeric_limits<size_t>::max(),
+        bool alignToEntries = false
+    );
+    ~BranchChunkReader();
+
+    /**
+     * @brief Fill chunk with the next chunkSize bytes of values.
+     *
+     * chunk is cleared and refilled in place, so its capacity is reused between calls.
+     *
+     * @param chunk Buffer receiving the next chunk of values.
+     * @return False once the branch (or maxBytes) is exhausted and chunk is empty.
+     */
+    bool next(std::vector<T>& chunk);
+
+    /** Number of entries and values handed out so far. */
+    size_t getEntriesRead() const;
+    size_t getValuesRead() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;    ///< ROOT file and reader state
+};
+
+/**
+ * @brief ROOT compression settings (algorithm * 100 + level) for an algorithm name.
+ * @param algorithm One of "zlib", "lzma", "lz4" or "zstd".
+ * @param level Compression level, 0..9.
+ * @throws std::invalid_argument if the algorithm is unknown or the level out of range.
+ */
+int rootCompressionSettings(const std::string& algorithm, int level);
+
+/**
+ * @brief Writes jagged columns as std::vector branches of a new tree, in one fill pass.
+ *
+ * Each column gets one branch, named after its key, whose entries are rebuilt from the
+ * column's offsets into a single reused std::vector per branch, so the tree is filled
+ * once per entry with every branch at a time and no entry is ever read back. Baskets are
+ * sized for bulk writes and the tree is flushed every autoFlushBytes; if ROOT's implicit
+ * multithreading is enabled, baskets of a flush are compressed in parallel.
+ *
+ * @param filename       Path to the ROOT file, which is overwritten.
+ * @param treename       Name of the tree to create.
+ * @param columns        Map of branch name to column; all columns must have the same number of entries.
+ * @param compressionSettings ROOT compression settings of the file (see rootCompressionSettings()),
+ *                       or -1 for ROOT's default.
+ * @param basketSize     Initial basket size of every branch, in bytes.
+ * @param autoFlushBytes Bytes filled between flushes of all baskets to the file.
+ * @throws std::invalid_argument if there are no columns or their entry counts differ.
+ * @throws std::runtime_error if the file cannot be created or written.
+ */
+void writeVectorBranches(
+    const std::string& filename,
+    const std::string& treename,
+    const std::map<std::string, AnyColumnView>& columns,
+    int compressionSettings = -1,
+    int basketSize = 256 * 1024,
+    long long autoFlushBytes = 64 * 1024 * 1024
+);
+
+/**
+ * @brief Writes the decompressed columns of a benchmark to a new tree with ROOT's default
+ *        compression (see writeVectorBranches()).
+ */
+void writeDecompressedDataToRootFile(
+    const std::string& filename,
+    const std::string& treename,
+    const std::map<std::string, AnyColumn>& columns,
+    int basketSize = 256 * 1024,
+    long long autoFlushBytes = 64 * 1024 * 1024
+);
\ No newline at end of file